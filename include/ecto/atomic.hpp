@@ -29,6 +29,9 @@
 #pragma once
 #include <boost/thread.hpp>
 #include <boost/noncopyable.hpp>
+#if !defined(__GNUC__)
+#include <boost/smart_ptr/detail/spinlock_pool.hpp>
+#endif
 
 namespace ecto
 {
@@ -62,4 +65,74 @@ namespace ecto
 
   };
 
+  //! Size used to keep independently written words on separate cache lines.
+  enum { CACHE_LINE_SIZE = 64 };
+
+  //
+  //  acquire/release access to a word that has exactly one writer,
+  //  e.g. the head and tail indices of a single producer/consumer queue.
+  //
+  template <typename T>
+  inline T load_acquire(const volatile T& v)
+  {
+#if defined(__GNUC__) && (__GNUC__ > 4 || (__GNUC__ == 4 && __GNUC_MINOR__ >= 7))
+    return __atomic_load_n(&v, __ATOMIC_ACQUIRE);
+#elif defined(__GNUC__)
+    T r = v;
+    __sync_synchronize();
+    return r;
+#else
+    // msvc gives volatile reads acquire semantics
+    return v;
+#endif
+  }
+
+  template <typename T>
+  inline void store_release(volatile T& v, T value)
+  {
+#if defined(__GNUC__) && (__GNUC__ > 4 || (__GNUC__ == 4 && __GNUC_MINOR__ >= 7))
+    __atomic_store_n(&v, value, __ATOMIC_RELEASE);
+#elif defined(__GNUC__)
+    __sync_synchronize();
+    v = value;
+#else
+    // msvc gives volatile writes release semantics
+    v = value;
+#endif
+  }
+
+  //
+  //  compare and swap, with a full barrier: if v == expected it becomes
+  //  desired. Returns what v held before either way.
+  //
+  template <typename T>
+  inline T compare_and_swap(volatile T& v, T expected, T desired)
+  {
+#if defined(__GNUC__)
+    return __sync_val_compare_and_swap(&v, expected, desired);
+#else
+    boost::detail::spinlock_pool<0>::scoped_lock lock(const_cast<T*>(&v));
+    T old = v;
+    if (old == expected)
+      v = desired;
+    return old;
+#endif
+  }
+
+  //
+  //  add to v, with a full barrier. Returns what v held before.
+  //
+  template <typename T>
+  inline T fetch_and_add(volatile T& v, T d)
+  {
+#if defined(__GNUC__)
+    return __sync_fetch_and_add(&v, d);
+#else
+    boost::detail::spinlock_pool<0>::scoped_lock lock(const_cast<T*>(&v));
+    T old = v;
+    v = old + d;
+    return old;
+#endif
+  }
+
 }
@@ -29,6 +29,7 @@
 #pragma once
 
 
+#include <boost/bind.hpp>
 #include <boost/shared_ptr.hpp>
 #include <boost/noncopyable.hpp>
 #include <boost/optional.hpp>
@@ -36,6 +37,8 @@
 #include <ecto/forward.hpp>
 #include <ecto/tendril.hpp>
 #include <ecto/tendrils.hpp>
+#include <ecto/tendrils_batch.hpp>
+#include <ecto/completion.hpp>
 #include <ecto/strand.hpp>
 #include <ecto/util.hpp>
 #include <ecto/profile.hpp>
@@ -139,6 +142,46 @@ namespace ecto
      */
     ReturnCode process();
 
+    /**
+     * \brief The schedulers' per tick process().  The first call after start()
+     * configures the cell and verifies its inputs, later ones go straight to
+     * the client's process, and exceptions are translated out of line.
+     */
+    ReturnCode process_running();
+
+    /**
+     * \brief True if the client has a process_batch, taking several ticks
+     * per call.
+     */
+    bool batched() const;
+
+    /**
+     * \brief process_running() for n ticks at once, of a batched() cell.
+     * in and out hold a column of n values per port, see tendrils_batch.
+     */
+    ReturnCode process_batch(const tendrils_batch& in, tendrils_batch& out, std::size_t n);
+
+    /**
+     * \brief True if the client has a process_async, which starts a tick
+     * and finishes it later through a completion.  Schedulers that don't
+     * park ticks run it through process(), which waits.
+     */
+    bool async() const;
+
+    /**
+     * \brief process_running() for an async() cell: start the tick, c
+     * finishes it.  c is called once whatever this returns, unless it
+     * throws.
+     */
+    ReturnCode process_async(const completion& c);
+
+    /**
+     * \brief The plasm this cell runs once per tick in its process(), e.g.
+     * a BlackBox, null for other cells.  Its cells share the tendrils this
+     * cell exports, so plasm::flatten() may splice them in its place.
+     */
+    plasm_ptr subgraph() const;
+
     /**
      * \brief Return the type of the child class.
      * @return A human readable non mangled name for the client class.
@@ -169,6 +212,14 @@ namespace ecto
     void reset_strand();
     void set_strand(ecto::strand);
 
+    /**
+     * \brief Of the cells ready to run at once, the ones with the higher
+     * priority go first, where the scheduler orders its work (see
+     * schedulers::dataflow).  0 by default.
+     */
+    int priority() const;
+    void priority(int p);
+
     /**
      * \brief Generate an Restructured Text doc string for the cell. Includes documentation for all parameters,
      * inputs, outputs.
@@ -186,19 +237,24 @@ namespace ecto
     tendrils inputs; //!< Inputs, inboxes, always have a valid value ( may be NULL )
     tendrils outputs; //!< Outputs, outboxes, always have a valid value ( may be NULL )
 
+    tendrils_batch batch_inputs; //!< Scratch for process_batch, laid out by the scheduler.
+    tendrils_batch batch_outputs; //!< Scratch for process_batch, laid out by the scheduler.
+
     boost::optional<strand> strand_; //!< The strand that this cell should be executed in.
     profile::stats_type stats; //!< For collecting execution statistics for process.
 
     virtual bool init() = 0;
 
     std::size_t tick() const;
+    //! Skip ahead to tick, for a cell downstream of a lossy edge.
+    void tick(std::size_t t);
     void inc_tick();
     void reset_tick();
 
     bool stop_requested() const { return stop_requested_; }
     void stop_requested(bool b) { stop_requested_ = b; }
 
-    boost::signals2::signal<void(cell&, bool)> bsig_process;
+    hook<void(cell&, bool)> bsig_process;
 
   protected:
 
@@ -212,6 +268,34 @@ namespace ecto
 
     virtual ReturnCode dispatch_process(const tendrils& inputs, const tendrils& outputs) = 0;
 
+    virtual bool dispatch_async() const
+    {
+      return false;
+    }
+
+    virtual ReturnCode dispatch_process_async(const tendrils& /*inputs*/, const tendrils& /*outputs*/,
+                                              const completion& c)
+    {
+      c(OK);
+      return OK;
+    }
+
+    virtual bool dispatch_batched() const
+    {
+      return false;
+    }
+
+    virtual plasm_ptr dispatch_subgraph() const
+    {
+      return plasm_ptr();
+    }
+
+    virtual ReturnCode dispatch_process_batch(const tendrils_batch& /*inputs*/, tendrils_batch& /*outputs*/,
+                                              std::size_t /*n*/)
+    {
+      return OK;
+    }
+
     virtual void dispatch_start() = 0;
     virtual void dispatch_stop() = 0;
 
@@ -230,9 +314,20 @@ namespace ecto
 
     cell(const cell&);
 
+    void notify_params();
+    void begin_process();
+    ReturnCode process_failed();
+    void process_async_done(const completion& c, int rval, const boost::exception_ptr& e);
+
     std::string instance_name_;
     bool stop_requested_;
     bool configured;
+    //! set by the first process_running() after start()
+    bool running_;
+    std::string running_name_;
+    int priority_;
+    //! the parameters changed since the last process()
+    dirty_list_ptr dirty_params_;
     std::size_t tick_;
     boost::mutex mtx;
 #if defined(ECTO_STRESS_TEST)
@@ -292,6 +387,33 @@ namespace ecto
       process = sizeof(test_process<T> (0)) == sizeof(yes)
     };
 
+    template<class U>
+    static yes test_process_batch(__typeof__(&U::process_batch));
+    template<class U>
+    static no test_process_batch(...);
+    enum
+    {
+      process_batch = sizeof(test_process_batch<T> (0)) == sizeof(yes)
+    };
+
+    template<class U>
+    static yes test_process_async(__typeof__(&U::process_async));
+    template<class U>
+    static no test_process_async(...);
+    enum
+    {
+      process_async = sizeof(test_process_async<T> (0)) == sizeof(yes)
+    };
+
+    template<class U>
+    static yes test_subgraph(__typeof__(&U::subgraph));
+    template<class U>
+    static no test_subgraph(...);
+    enum
+    {
+      subgraph = sizeof(test_subgraph<T> (0)) == sizeof(yes)
+    };
+
     template<class U>
     static yes test_start(__typeof__(&U::start));
     template<class U>
@@ -400,9 +522,10 @@ namespace ecto
     //
     // process
     //
-    ReturnCode process(const tendrils&, const tendrils&, not_implemented)
+    ReturnCode process(const tendrils& inputs, const tendrils& outputs, not_implemented)
     {
-      return OK;
+      //an async cell, run by a scheduler that doesn't park ticks.
+      return process_blocking(inputs, outputs, int_<has_f<Impl>::process_async> ());
     }
 
     ReturnCode process(const tendrils& inputs, const tendrils& outputs, implemented)
@@ -415,6 +538,86 @@ namespace ecto
       return process(inputs, outputs, int_<has_f<Impl>::process> ());
     }
 
+    //
+    // process_async
+    //
+    ReturnCode process_blocking(const tendrils&, const tendrils&, not_implemented)
+    {
+      return OK;
+    }
+
+    ReturnCode process_blocking(const tendrils& inputs, const tendrils& outputs, implemented)
+    {
+      return ReturnCode(wait_for(boost::bind(&Impl::process_async, impl.get(),
+                                             boost::cref(inputs), boost::cref(outputs), _1)));
+    }
+
+    ReturnCode process_async(const tendrils&, const tendrils&, const completion& c, not_implemented)
+    {
+      c(OK);
+      return OK;
+    }
+
+    ReturnCode process_async(const tendrils& inputs, const tendrils& outputs, const completion& c,
+                             implemented)
+    {
+      return ReturnCode(impl->process_async(inputs, outputs, c));
+    }
+
+    bool dispatch_async() const
+    {
+      return has_f<Impl>::process_async;
+    }
+
+    ReturnCode dispatch_process_async(const tendrils& inputs, const tendrils& outputs,
+                                      const completion& c)
+    {
+      return process_async(inputs, outputs, c, int_<has_f<Impl>::process_async> ());
+    }
+
+    //
+    // process_batch
+    //
+    ReturnCode process_batch(const tendrils_batch&, tendrils_batch&, std::size_t, not_implemented)
+    {
+      return OK;
+    }
+
+    ReturnCode process_batch(const tendrils_batch& inputs, tendrils_batch& outputs, std::size_t n,
+                             implemented)
+    {
+      return ReturnCode(impl->process_batch(inputs, outputs, n));
+    }
+
+    bool dispatch_batched() const
+    {
+      return has_f<Impl>::process_batch;
+    }
+
+    ReturnCode dispatch_process_batch(const tendrils_batch& inputs, tendrils_batch& outputs,
+                                      std::size_t n)
+    {
+      return process_batch(inputs, outputs, n, int_<has_f<Impl>::process_batch> ());
+    }
+
+    //
+    // subgraph
+    //
+    plasm_ptr subgraph_of(not_implemented) const
+    {
+      return plasm_ptr();
+    }
+
+    plasm_ptr subgraph_of(implemented) const
+    {
+      return impl ? impl->subgraph() : plasm_ptr();
+    }
+
+    plasm_ptr dispatch_subgraph() const
+    {
+      return subgraph_of(int_<has_f<Impl>::subgraph> ());
+    }
+
     //
     // start
     //
@@ -499,7 +702,21 @@ namespace ecto
     {
     } // threadsafe
 
-    void init_strand(boost::mpl::false_) {
+    void init_strand(boost::mpl::false_)
+    {
+      init_unsafe_strand(typename ecto::detail::unsafe_per_instance<Impl>::type());
+    }
+
+    // ECTO_THREAD_UNSAFE_PER_INSTANCE
+    void init_unsafe_strand(boost::mpl::true_)
+    {
+      cell::strand_ = ecto::strand();
+      ECTO_LOG_DEBUG("%s cell has its own strand id=%p", cell::type() % cell::strand_->id());
+    }
+
+    // ECTO_THREAD_UNSAFE, one strand for every instance of the type
+    void init_unsafe_strand(boost::mpl::false_)
+    {
       static ecto::strand strand_;
       cell::strand_ = strand_;
       ECTO_ASSERT(cell::strand_->id() == strand_.id(), "Catastrophe... cells not correctly assignable");
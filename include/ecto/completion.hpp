@@ -0,0 +1,88 @@
+/*
+ * Copyright (c) 2011, Willow Garage, Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the Willow Garage, Inc. nor the names of its
+ *       contributors may be used to endorse or promote products derived from
+ *       this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#pragma once
+#include <ecto/forward.hpp>
+#include <ecto/util.hpp>
+
+#include <boost/asio.hpp>
+#include <boost/exception_ptr.hpp>
+#include <boost/function.hpp>
+#include <boost/shared_ptr.hpp>
+
+namespace ecto
+{
+  /**
+   * \brief The end of one tick of an asynchronous cell.
+   *
+   * A cell with a process_async(inputs, outputs, completion) starts its work
+   * there (a read, a timer, a request to another process) and returns OK
+   * without waiting for it.  Once its outputs are written it calls the
+   * completion, from any thread, even before process_async returns if the
+   * work is already done, and the scheduler pushes the outputs
+   * downstream.  Meanwhile the scheduler runs other cells, but not the
+   * cell's next tick nor the cells on its strand.  The work may be run on
+   * service(), which the scheduler runs while the tick is out.
+   *
+   * Only the first call of a completion counts, copies share it.
+   */
+  class ECTO_EXPORT completion
+  {
+  public:
+    //! What the scheduler gets, the cell's return code or its exception.
+    typedef boost::function<void(int, const boost::exception_ptr&)> handler;
+
+    completion(boost::asio::io_service& s, const handler& h);
+
+    //! Finish the tick with the return code.
+    void operator()(int rval = 0) const;
+
+    /**
+     * \brief Finish the tick with an error, rethrown by the scheduler.  From
+     * a catch block: c.fail(boost::current_exception()).
+     */
+    void fail(const boost::exception_ptr& e) const;
+
+    bool done() const;
+
+    boost::asio::io_service& service() const;
+
+  private:
+    struct impl;
+    boost::shared_ptr<impl> impl_;
+  };
+
+  /**
+   * \brief Run an asynchronous process to the end in the calling thread,
+   * for schedulers that don't park ticks.  start is handed a completion on a
+   * private io_service, which is run until the completion is called.  The
+   * cell's exception, if any, is rethrown.
+   */
+  ECTO_EXPORT int
+  wait_for(const boost::function<int(const completion&)>& start);
+}
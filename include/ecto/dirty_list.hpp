@@ -0,0 +1,96 @@
+/*
+ * Copyright (c) 2011, Willow Garage, Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the Willow Garage, Inc. nor the names of its
+ *       contributors may be used to endorse or promote products derived from
+ *       this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#pragma once
+#include <ecto/forward.hpp>
+#include <ecto/util.hpp>
+
+#include <boost/enable_shared_from_this.hpp>
+#include <boost/noncopyable.hpp>
+#include <boost/weak_ptr.hpp>
+
+#include <vector>
+
+namespace ecto
+{
+  /**
+   * \brief The tendrils of one cell that have been set dirty since it last looked.
+   *
+   * A watched tendril queues itself here when it is set dirty, from any
+   * thread and without locking, so the cell notifies only the tendrils that
+   * changed instead of walking all of them every process().
+   */
+  class ECTO_EXPORT dirty_list : public boost::enable_shared_from_this<dirty_list>,
+                                 boost::noncopyable
+  {
+  public:
+    dirty_list();
+    ~dirty_list();
+
+    /**
+     * \brief Queue t here whenever it is set dirty, and now if it already is.
+     * Not thread safe, cells watch their tendrils when they are configured.
+     */
+    void watch(const tendril_ptr& t);
+
+    //! Nothing is queued.
+    bool empty() const;
+
+    /**
+     * \brief Call tendril::notify on each queued tendril, once. Only one thread
+     * may do this at a time, tendrils may be queued meanwhile. If a callback
+     * throws, the tendrils not notified yet stay queued.
+     */
+    void notify();
+
+    //! A tendril on this list, owned by the list.
+    struct node
+    {
+      tendril_ptr t;
+      node* volatile next;
+      volatile int queued;
+    };
+
+    //! What a watched tendril keeps, to find its way here.
+    struct watcher
+    {
+      boost::weak_ptr<dirty_list> list;
+      node* n;
+    };
+
+    //! Queue n, unless it already is.
+    void push(node* n);
+
+  private:
+    //! link in a chain of already queued nodes
+    void link(node* first);
+
+    node* volatile head_;
+    std::vector<node*> nodes_;
+  };
+}
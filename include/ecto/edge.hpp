@@ -32,23 +32,119 @@
 #include <ecto/forward.hpp>
 #include <boost/thread/mutex.hpp>
 #include <boost/shared_ptr.hpp>
+#include <boost/date_time/posix_time/posix_time_types.hpp>
 
 namespace ecto {
   namespace graph {
 
     struct edge
     {
-      edge(const std::string& fp, const std::string& tp); 
+      /**
+       * \brief The queue used to buffer values travelling along the edge.
+       */
+      enum queue_type {
+        DEQUE = 0, //!< A mutex guarded, unbounded queue.
+        RINGBUFFER //!< A lock free single producer/single consumer ring, sized to the edge's capacity.
+                   //!< An unbounded one spills to a locked queue once 16 values are waiting.
+      };
+
+      /**
+       * \brief What a bounded edge does with a value pushed while it is full.
+       */
+      enum overflow_policy {
+        BLOCK = 0, //!< The producer waits for the consumer to make room.
+        DROP_OLDEST, //!< The value at the front of the queue is discarded.
+        DROP_NEWEST //!< The value being pushed is discarded.
+      };
+
+      /**
+       * @param type If given, a type_ops id, and the type has a typed queue (see
+       * typed_edge_registrar) the edge stores just the values, not the tendrils
+       * around them. Both ports must hold that type.
+       */
+      edge(const std::string& fp, const std::string& tp, queue_type q = DEQUE,
+           std::size_t type = 0);
 
       const std::string& from_port();
       const std::string& to_port();
 
+      queue_type queue() const;
+
+      /**
+       * \brief Swap the queue implementation, this will throw if the edge is not empty.
+       */
+      void queue(queue_type q);
+
+      /**
+       * \brief Allocate the queue again from the calling thread, so that its
+       * memory is first touched, and on a NUMA system placed, by that
+       * thread.  This will throw if the edge is not empty.
+       */
+      void relocate();
+
+      //! The type_ops id of the type stored by a typed edge, 0 for a type erased edge.
+      std::size_t value_type() const;
+
+      /**
+       * \brief Limit the number of values buffered on the edge. The slots for
+       * capacity values are allocated up front.  This will throw if the edge
+       * holds more than capacity values.
+       * @param capacity The most values the edge holds, 0 means unbounded.
+       * @param policy What to do with a value pushed onto a full edge.
+       */
+      void bound(std::size_t capacity, overflow_policy policy = BLOCK);
+
+      std::size_t capacity() const;
+
+      overflow_policy overflow() const;
+
+      /**
+       * \brief True if values may be discarded, i.e. the consumer may
+       * not see every tick of the producer.
+       */
+      bool lossy() const;
+
+      //! The number of values discarded by the overflow policy.
+      std::size_t dropped() const;
+
+      /**
+       * \brief The total time the producer spent waiting on a full BLOCK edge.
+       * The schedulers throttle their sources to keep BLOCK edges from filling
+       * up (see plasm::connect), so this only adds up when the edge is pushed
+       * to directly.
+       */
+      boost::posix_time::time_duration blocked_time() const;
+
       tendril& front();
 
       void pop_front();
 
+      /**
+       * \brief Move the value at the front of the queue into t and pop it,
+       * see tendril::move_from. Consumers of a lossy edge must use this
+       * rather than front() and pop_front(), as the producer may pop too.
+       */
+      void take_front(ecto::tendril& t);
+
+      //! The tick of the value at the front, false if the edge is empty.
+      bool front_tick(std::size_t& tick);
+
+      /**
+       * \brief Discard the values older than tick, then take_front() into t
+       * if the front is the value of tick.  False if the edge holds none
+       * for tick.  For the consumer of an edge downstream of a lossy one,
+       * whose inputs have to be lined up by tick.
+       */
+      bool take_tick(std::size_t tick, ecto::tendril& t);
+
       void push_back(const ecto::tendril& t);
 
+      /**
+       * \brief Enqueue the value of t without copying it, see tendril::move_from.
+       * t is left holding a stale value.
+       */
+      void move_back(ecto::tendril& t);
+
       std::size_t size(); 
 
     private:
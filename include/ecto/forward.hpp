@@ -35,6 +35,9 @@ namespace ecto {
   typedef boost::shared_ptr<tendril> tendril_ptr;
   typedef boost::shared_ptr<const tendril> tendril_cptr;
 
+  class dirty_list;
+  typedef boost::shared_ptr<dirty_list> dirty_list_ptr;
+
   class tendrils;
   typedef boost::shared_ptr<tendrils> tendrils_ptr;
   typedef boost::shared_ptr<const tendrils> tendrils_cptr;
@@ -52,6 +55,8 @@ namespace ecto {
     typedef boost::shared_ptr<edge> edge_ptr;
     typedef boost::shared_ptr<const edge> edge_cptr;
     struct graph_t;
+    struct typed_slot;
+    struct queue_base;
   }
 
   struct strand;
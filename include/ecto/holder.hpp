@@ -0,0 +1,237 @@
+/*
+ * Copyright (c) 2011, Willow Garage, Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the Willow Garage, Inc. nor the names of its
+ *       contributors may be used to endorse or promote products derived from
+ *       this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#pragma once
+#include <boost/type_traits/alignment_of.hpp>
+#include <boost/type_traits/aligned_storage.hpp>
+#include <boost/type_traits/has_trivial_copy.hpp>
+#include <boost/type_traits/has_trivial_destructor.hpp>
+
+#include <algorithm>
+#include <cstring>
+#include <new>
+#include <typeinfo>
+
+namespace ecto
+{
+  /**
+   * \brief A type erasing value holder, in the spirit of boost::any, that keeps
+   * small values inline instead of allocating them.
+   *
+   * Types of at most INLINE_SIZE bytes with a trivial copy constructor and
+   * destructor (int, double, bool, small structs...) live in the holder
+   * itself; anything else is allocated on the heap.  Either way the holder
+   * can be swapped bytewise, and assigning a value of the type already held
+   * assigns in place.
+   */
+  class holder
+  {
+  public:
+    enum { INLINE_SIZE = 32 };
+
+    //! Is T stored inline?
+    template<typename T>
+    struct is_inline
+    {
+      static const bool value = sizeof(T) <= INLINE_SIZE
+        && boost::alignment_of<T>::value <= boost::alignment_of<boost::detail::max_align>::value
+        && boost::has_trivial_copy_constructor<T>::value
+        && boost::has_trivial_destructor<T>::value;
+    };
+
+    holder()
+      : storage_(), table_(0)
+    { }
+
+    template<typename T>
+    holder(const T& v)
+      : storage_(), table_(0)
+    {
+      construct(v);
+    }
+
+    holder(const holder& rhs)
+      : storage_(), table_(0)
+    {
+      if (rhs.table_)
+        rhs.table_->clone(rhs.storage_, storage_);
+      table_ = rhs.table_;
+    }
+
+    ~holder()
+    {
+      clear();
+    }
+
+    holder& operator=(const holder& rhs)
+    {
+      if (this == &rhs)
+        return *this;
+      if (table_ && same_type(rhs))
+      {
+        table_->assign(storage_, rhs.storage_);
+        return *this;
+      }
+      holder(rhs).swap(*this);
+      return *this;
+    }
+
+    template<typename T>
+    holder& operator=(const T& v)
+    {
+      if (table_ == &table<T>::instance)
+        *unsafe_get<T>() = v;
+      else
+        holder(v).swap(*this); //the old value stays if copying v throws
+      return *this;
+    }
+
+    void swap(holder& rhs)
+    {
+      // inline values are trivially copyable, heap values are a pointer.
+      // The storage is zeroed on construction, so the bytes a value leaves
+      // unwritten are never read uninitialised here.
+      storage_t tmp = storage_t();
+      std::memcpy(&tmp, &storage_, sizeof(storage_t));
+      std::memcpy(&storage_, &rhs.storage_, sizeof(storage_t));
+      std::memcpy(&rhs.storage_, &tmp, sizeof(storage_t));
+      std::swap(table_, rhs.table_);
+    }
+
+    bool empty() const
+    {
+      return table_ == 0;
+    }
+
+    const std::type_info& type() const
+    {
+      return table_ ? table_->type() : typeid(void);
+    }
+
+    bool same_type(const holder& rhs) const
+    {
+      return table_ == rhs.table_ || type() == rhs.type();
+    }
+
+    //! No checks, the caller knows that T is held.
+    template<typename T>
+    T* unsafe_get()
+    {
+      return access<T>(storage_);
+    }
+
+    template<typename T>
+    const T* unsafe_get() const
+    {
+      return access<T>(const_cast<storage_t&>(storage_));
+    }
+
+  private:
+    typedef boost::aligned_storage<INLINE_SIZE>::type storage_t;
+
+    struct vtable
+    {
+      const std::type_info& (*type)();
+      void (*clone)(const storage_t& from, storage_t& to);
+      void (*assign)(storage_t& to, const storage_t& from);
+      void (*destroy)(storage_t& s);
+    };
+
+    template<typename T>
+    static T* access(storage_t& s)
+    {
+      if (is_inline<T>::value)
+        return reinterpret_cast<T*>(&s);
+      return *reinterpret_cast<T**>(&s);
+    }
+
+    template<typename T>
+    struct table
+    {
+      static const std::type_info& type()
+      {
+        return typeid(T);
+      }
+
+      static void clone(const storage_t& from, storage_t& to)
+      {
+        create<T>(to, *access<T>(const_cast<storage_t&>(from)));
+      }
+
+      static void assign(storage_t& to, const storage_t& from)
+      {
+        *access<T>(to) = *access<T>(const_cast<storage_t&>(from));
+      }
+
+      static void destroy(storage_t& s)
+      {
+        if (is_inline<T>::value)
+          access<T>(s)->~T();
+        else
+          delete access<T>(s);
+      }
+
+      static const vtable instance;
+    };
+
+    template<typename T>
+    static void create(storage_t& s, const T& v)
+    {
+      if (is_inline<T>::value)
+        new (&s) T(v);
+      else
+        new (&s) T*(new T(v));
+    }
+
+    template<typename T>
+    void construct(const T& v)
+    {
+      create<T>(storage_, v);
+      table_ = &table<T>::instance;
+    }
+
+    void clear()
+    {
+      if (table_)
+        table_->destroy(storage_);
+      table_ = 0;
+    }
+
+    storage_t storage_;
+    const vtable* table_;
+  };
+
+  template<typename T>
+  const holder::vtable holder::table<T>::instance =
+    {
+      &holder::table<T>::type,
+      &holder::table<T>::clone,
+      &holder::table<T>::assign,
+      &holder::table<T>::destroy
+    };
+}
@@ -0,0 +1,203 @@
+/*
+ * Copyright (c) 2011, Willow Garage, Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the Willow Garage, Inc. nor the names of its
+ *       contributors may be used to endorse or promote products derived from
+ *       this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#pragma once
+#include <ecto/atomic.hpp>
+
+#include <boost/function.hpp>
+#include <boost/noncopyable.hpp>
+#include <boost/shared_ptr.hpp>
+#include <boost/weak_ptr.hpp>
+#include <boost/thread/mutex.hpp>
+
+#include <vector>
+
+namespace ecto
+{
+  /**
+   * \brief A list of callbacks, for the hooks that are fired every tick.
+   *
+   * Unlike a boost::signals2::signal, firing a hook takes no lock and
+   * allocates nothing: it loads an atomically published, immutable vector
+   * of slots and calls each.  A hook that was never connected costs one
+   * load and one branch.  connect and disconnect copy the vector and
+   * publish the copy.  The vectors they replace are kept until the hook
+   * goes away, since a concurrent firing may still be walking one, so
+   * hooks are for callbacks connected once, at setup.
+   *
+   * Signature is void(A1) or void(A1, A2).
+   */
+  template <typename Signature>
+  class hook : boost::noncopyable
+  {
+  public:
+    typedef boost::function<Signature> slot_type;
+
+  private:
+    struct slot
+    {
+      slot_type f;
+      std::size_t id;
+    };
+
+    typedef std::vector<slot> slots_t;
+
+    //! the slots, shared with connections so that they may outlive the hook.
+    struct impl : boost::noncopyable
+    {
+      impl()
+        : slots(0)
+        , next_id(0)
+      { }
+
+      ~impl()
+      {
+        delete slots;
+        for (std::size_t i = 0; i < retired.size(); ++i)
+          delete retired[i];
+      }
+
+      //! under mtx
+      void publish(slots_t* s)
+      {
+        if (slots)
+          retired.push_back(static_cast<slots_t*>(slots));
+        store_release(slots, s);
+      }
+
+      slots_t* volatile slots;
+      std::vector<slots_t*> retired;
+      std::size_t next_id;
+      boost::mutex mtx;
+    };
+
+  public:
+    class connection
+    {
+    public:
+      connection()
+        : id(0)
+      { }
+
+      //! Remove the slot from the hook, if both are still around.
+      void disconnect()
+      {
+        boost::shared_ptr<impl> i = owner.lock();
+        if (!i)
+          return;
+        boost::mutex::scoped_lock lock(i->mtx);
+        if (!i->slots)
+          return;
+        slots_t* s = new slots_t;
+        for (typename slots_t::const_iterator it = i->slots->begin(); it != i->slots->end(); ++it)
+          if (it->id != id)
+            s->push_back(*it);
+        if (s->empty())
+        {
+          delete s;
+          s = 0;
+        }
+        i->publish(s);
+        owner.reset();
+      }
+
+      bool connected() const
+      {
+        return !owner.expired();
+      }
+
+    private:
+      friend class hook;
+      boost::weak_ptr<impl> owner;
+      std::size_t id;
+    };
+
+    hook()
+      : impl_(0)
+    { }
+
+    template <typename Slot>
+    connection connect(const Slot& f)
+    {
+      {
+        boost::mutex::scoped_lock lock(mtx_);
+        if (!owner_)
+        {
+          owner_.reset(new impl);
+          store_release(impl_, owner_.get());
+        }
+      }
+      boost::mutex::scoped_lock lock(owner_->mtx);
+      slots_t* s = owner_->slots ? new slots_t(*owner_->slots) : new slots_t;
+      slot sl = { slot_type(f), ++owner_->next_id };
+      s->push_back(sl);
+      owner_->publish(s);
+      connection c;
+      c.owner = owner_;
+      c.id = sl.id;
+      return c;
+    }
+
+    bool empty() const
+    {
+      impl* i = load_acquire(impl_);
+      return !i || !load_acquire(i->slots);
+    }
+
+    template <typename A1>
+    void operator()(A1& a1) const
+    {
+      impl* i = load_acquire(impl_);
+      if (!i)
+        return;
+      const slots_t* s = load_acquire(i->slots);
+      if (!s)
+        return;
+      for (typename slots_t::const_iterator it = s->begin(); it != s->end(); ++it)
+        it->f(a1);
+    }
+
+    template <typename A1, typename A2>
+    void operator()(A1& a1, const A2& a2) const
+    {
+      impl* i = load_acquire(impl_);
+      if (!i)
+        return;
+      const slots_t* s = load_acquire(i->slots);
+      if (!s)
+        return;
+      for (typename slots_t::const_iterator it = s->begin(); it != s->end(); ++it)
+        it->f(a1, a2);
+    }
+
+  private:
+    impl* volatile impl_;
+    boost::shared_ptr<impl> owner_;
+    boost::mutex mtx_;
+  };
+}
@@ -40,6 +40,7 @@
 
 #include <ecto/forward.hpp>
 #include <ecto/tendril.hpp>
+#include <ecto/edge.hpp>
 
 namespace ecto
 {
@@ -76,6 +77,21 @@ namespace ecto
     void
     connect(cell_ptr from, const std::string& output, cell_ptr to, const std::string& input);
 
+    /**
+     * \brief Connect one cell to another with a bounded edge.
+     * @param capacity The most values buffered on the edge, 0 means unbounded.
+     * @param policy What happens when the producer gets capacity values ahead of the
+     * consumer: it blocks, or the oldest or newest value is dropped. Cells downstream
+     * of a dropped value skip that tick. A producer waiting on a BLOCK edge holds its
+     * strand and thread, so where that could stall its consumer for good (a cell on
+     * the same strand lies between them, the pool has too few idle threads, or under
+     * the pipelined scheduler) the schedulers throttle the source instead: they keep
+     * no more ticks in flight than the edge holds, and its blocked_time() stays 0.
+     */
+    void
+    connect(cell_ptr from, const std::string& output, cell_ptr to, const std::string& input,
+            std::size_t capacity, graph::edge::overflow_policy policy = graph::edge::BLOCK);
+
     /**
      * Disconnect a tendril from another tendril.
      *
@@ -86,6 +102,32 @@ namespace ecto
      */
     void
     disconnect(cell_ptr from, const std::string& output, cell_ptr to, const std::string& input);
+
+    /**
+     * \brief The queue implementation used by the edges of this plasm.
+     */
+    graph::edge::queue_type
+    edge_queue() const;
+
+    /**
+     * \brief Select the queue implementation for all edges of this plasm, existing
+     * and future. The edges must be empty, i.e. the plasm may not be executing.
+     * @param q ecto::graph::edge::DEQUE or ecto::graph::edge::RINGBUFFER
+     */
+    void
+    edge_queue(graph::edge::queue_type q);
+
+    /**
+     * \brief The time each tick has, from its sources starting it to its sinks
+     * finishing it.  Schedulers that order their work run the ticks closest
+     * to their deadline first and count the ticks that finish late, see
+     * scheduler::stats().  Zero, the default, means no deadline.
+     */
+    boost::posix_time::time_duration
+    deadline() const;
+
+    void
+    deadline(const boost::posix_time::time_duration& d);
     /**
      * \brief output graphviz to a stream.
      * @param out the output stream. Graphviz will be in plain text format.
@@ -107,6 +149,18 @@ namespace ecto
     void
     check() const;
 
+    /**
+     * \brief Splice the cells and edges of each cell's subgraph() (e.g. a
+     * BlackBox run once per tick) into this plasm, in place of the cell.
+     * The edges to and from the cell are moved to the inner cells whose
+     * tendrils it exports, so the inner cells are scheduled like any
+     * other, with no nested scheduler.  Nested subgraphs are flattened too.
+     * Call it before handing the plasm to a scheduler.
+     * @return the number of cells replaced.
+     */
+    std::size_t
+    flatten();
+
     /**
      * \brief Get the underlying boost graph that this plasm has constructed.
      * @return
@@ -45,6 +45,11 @@ namespace ecto {
       boost::posix_time::ptime start_time, stop_time;
       boost::posix_time::time_duration cumulative_time;
       unsigned long start_tick, stop_tick, cumulative_ticks;
+      //! ticks run against the plasm's deadline, those that finished late,
+      //! those whose cells were given different deadlines and the latest any
+      //! of them finished
+      std::size_t deadline_ticks, deadline_misses, deadline_splits;
+      boost::posix_time::time_duration worst_lateness;
       graph_stats_type();
       void start();
       void stop();
@@ -39,10 +39,17 @@
 #include <boost/asio.hpp>
 #include <boost/unordered_map.hpp>
 
+#include <map>
+#include <vector>
+
 #include <ecto/impl/graph_types.hpp>
 
 namespace ecto {
 
+  namespace schedulers {
+    struct plan;
+  }
+
   void verbose_run(boost::asio::io_service& s, std::string name);
 
   struct scheduler {
@@ -61,16 +68,57 @@ namespace ecto {
 
     std::string stats();
 
+    /**
+     * \brief Pin worker threads to these cpus, worker j to cpus[j % size].
+     * Empty, the default, leaves them unpinned.  With cpus set, an execute
+     * with nthread 0 runs one worker per cpu.
+     */
+    void cpus(const std::vector<unsigned>& c);
+    std::vector<unsigned> cpus() const;
+
+    //! Pin workers to one cpu per physical core, see affinity::physical_cores.
+    void one_per_core();
+
+    /**
+     * \brief Keep c on a NUMA node: the buffers of its edges are allocated
+     * from a thread on that node, and schedulers that place cells on workers
+     * run it on one pinned there.  -1 unbinds it.
+     */
+    void numa_node(const cell_ptr& c, int node);
+    int numa_node(const cell_ptr& c) const;
+
+    //! The cpu each worker of the last run was pinned to, -1 where it wasn't.
+    std::vector<int> placement() const;
+
+    /**
+     * \brief Run up to n ticks of each cell in a row, handing cells with a
+     * process_batch all of them in one call.  Lowered to the capacity of
+     * the smallest bounded edge.  The singlethreaded and pipelined
+     * schedulers batch, 1, the default, runs tick by tick.
+     */
+    void batch(unsigned n);
+    unsigned batch() const;
+
   protected:
 
     virtual int execute_impl(unsigned niter, unsigned nthread, boost::asio::io_service& topserv) = 0;
     virtual void stop_impl() = 0;
     virtual void interrupt_impl() = 0;
     virtual void wait_impl() = 0;
+    //! called by compute_stack once the plan is built, for schedulers that plan further ahead.
+    virtual void compute_stack_impl() { }
 
     void running(bool);
 
-    int invoke_process(ecto::graph::graph_t::vertex_descriptor vd);
+    /**
+     * \brief The cpu to pin worker j to, -1 for none, recorded in
+     * placement().  If node is not -1 a cpu on that node is preferred, from
+     * any the process may use if no cpus were given.
+     */
+    int worker_cpu(unsigned j, int node = -1);
+
+    //! n ticks of the step, see schedulers::invoke_process_batch
+    int invoke_process(std::size_t step, std::size_t n = 1);
     void compute_stack();
 
     plasm_ptr plasm;
@@ -78,6 +126,9 @@ namespace ecto {
 
     std::vector<ecto::graph::graph_t::vertex_descriptor> stack;
 
+    //! the stack with edges and ports resolved, what the schedulers run
+    boost::shared_ptr<const schedulers::plan> plan;
+
     profile::graph_stats_type graphstats;
 
     boost::thread runthread;
@@ -88,6 +139,7 @@ namespace ecto {
 
     void notify_start();
     void notify_stop();
+    void place_buffers();
 
     struct exec {
       scheduler& s;
@@ -102,6 +154,14 @@ namespace ecto {
     mutable boost::recursive_mutex running_mtx;
 
     mutable boost::recursive_mutex iface_mtx;
+
+    unsigned batch_;
+    std::vector<unsigned> cpus_;
+    std::map<cell_ptr, int> nodes_;
+    //! the edges of bound cells have been relocated since the last numa_node()
+    bool placed_;
+    std::vector<int> placement_;
+    mutable boost::mutex placement_mtx_;
   };
 
 }
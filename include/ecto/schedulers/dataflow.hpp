@@ -0,0 +1,100 @@
+/*
+ * Copyright (c) 2011, Willow Garage, Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the Willow Garage, Inc. nor the names of its
+ *       contributors may be used to endorse or promote products derived from
+ *       this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#pragma once
+#include <ecto/plasm.hpp>
+#include <ecto/scheduler.hpp>
+#include <ecto/cell.hpp>
+#include <ecto/thread_pool.hpp>
+
+#include <boost/shared_ptr.hpp>
+#include <boost/thread.hpp>
+
+namespace ecto {
+
+  namespace schedulers {
+
+    /**
+     * \brief Runs each cell as soon as its inputs for a tick are ready.
+     *
+     * Where multithreaded walks the stack in order, dataflow keeps a
+     * dependency counter for every cell and tick, so independent branches of
+     * the graph run at the same time on the same tick, and several ticks may
+     * be in progress at once.  Ready cells go on the deque of the worker that
+     * readied them, idle workers steal from the others.  A cell never runs
+     * two ticks at once, and cells that share a strand (e.g. those that are
+     * not thread safe) never run at the same time.
+     *
+     * If any cell has a priority or the plasm has a deadline, workers take
+     * the most urgent ready cell instead: highest priority, then earliest
+     * deadline (the plasm's deadline after the tick was started), then
+     * oldest tick.  Ticks that finish late are counted in stats().
+     *
+     * A tick of an async cell is parked once its process_async() has
+     * started, without holding a worker; the thread that called execute()
+     * runs the io_service the cell's completion hands out, and the tick
+     * finishes whenever the completion is called.
+     */
+    class ECTO_EXPORT dataflow : public scheduler
+    {
+    public:
+      explicit dataflow(plasm_ptr);
+      ~dataflow();
+
+      /**
+       * \brief The most ticks that may be in progress at once, at least 1.
+       * Bounded edges that block lower it to their capacity, so that a
+       * producer never waits on a full edge.
+       */
+      void ticks_in_flight(unsigned n);
+      unsigned ticks_in_flight() const;
+
+      int execute_impl(unsigned niter, unsigned nthread, boost::asio::io_service& topserv);
+
+      void stop_impl();
+      void interrupt_impl();
+      void wait_impl();
+
+    private:
+
+      struct state;
+      struct worker;
+
+      unsigned ticks_in_flight_;
+      boost::shared_ptr<state> state_;
+      //! the workers, borrowed from thread_pool::shared() for one execute
+      boost::shared_ptr<thread_pool::crew> crew_;
+      boost::mutex state_mtx_;
+
+      using scheduler::graph;
+      using scheduler::stack;
+      using scheduler::plan;
+      using scheduler::plasm;
+    };
+  }
+}
@@ -33,6 +33,7 @@
 #include <ecto/cell.hpp>
 #include <ecto/strand.hpp>
 #include <ecto/atomic.hpp>
+#include <ecto/thread_pool.hpp>
 
 #include <boost/asio.hpp>
 
@@ -66,11 +67,14 @@ namespace ecto {
 
       atomic<unsigned> current_iter;
 
-      boost::thread_group threads;
+      //! the pool threads running workserv, borrowed for one execute
+      boost::shared_ptr<thread_pool::crew> crew;
+      boost::mutex crew_mtx;
 
       using scheduler::top_serv;
       using scheduler::graph;
       using scheduler::stack;
+      using scheduler::plan;
       using scheduler::plasm;
 
       friend struct stack_runner;
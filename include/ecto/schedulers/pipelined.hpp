@@ -0,0 +1,115 @@
+/*
+ * Copyright (c) 2011, Willow Garage, Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the Willow Garage, Inc. nor the names of its
+ *       contributors may be used to endorse or promote products derived from
+ *       this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#pragma once
+#include <ecto/plasm.hpp>
+#include <ecto/scheduler.hpp>
+#include <ecto/cell.hpp>
+
+#include <boost/shared_ptr.hpp>
+#include <boost/thread.hpp>
+
+#include <map>
+#include <vector>
+
+namespace ecto {
+
+  namespace schedulers {
+
+    /**
+     * \brief Runs the stack as a pipeline of stages, each on its own thread.
+     *
+     * The stack is cut into contiguous stages.  A stage's thread runs its
+     * cells in order for one tick, then hands the tick to the next stage
+     * through a bounded queue, so a cell always runs on the same thread and
+     * successive ticks overlap across stages.  At most max_in_flight ticks
+     * are between the first stage starting them and the last finishing them,
+     * fewer if a bounded BLOCK edge holds fewer.
+     *
+     * Stages are either set by hand (stage()) or cut automatically, into
+     * nstages() stages or, if that is 0, nthreads stages, balancing the
+     * average process time of the cells recorded in their stats by earlier
+     * runs (equal costs before the first run).
+     */
+    class ECTO_EXPORT pipelined : public scheduler
+    {
+    public:
+      explicit pipelined(plasm_ptr);
+      ~pipelined();
+
+      //! The number of stages to cut automatically, 0 for one per thread.
+      void nstages(unsigned n);
+      unsigned nstages() const;
+
+      //! The most ticks in progress at once, at least 1.
+      void max_in_flight(unsigned n);
+      unsigned max_in_flight() const;
+
+      /**
+       * \brief Put c in stage k, turning automatic partitioning off.  Cells
+       * not placed by hand go in the latest stage of their producers.  A
+       * cell's stage may not be before that of any of its producers.
+       */
+      void stage(const cell_ptr& c, unsigned k);
+
+      //! Go back to automatic partitioning.
+      void clear_stages();
+
+      //! The cells of each stage of the last run, in the order they run.
+      std::vector<std::vector<cell_ptr> > layout() const;
+
+      int execute_impl(unsigned niter, unsigned nthread, boost::asio::io_service& topserv);
+
+      void stop_impl();
+      void interrupt_impl();
+      void wait_impl();
+
+    private:
+
+      struct state;
+      struct runner;
+
+      void partition(unsigned nthread);
+
+      unsigned nstages_, max_in_flight_;
+      std::map<cell_ptr, unsigned> manual_;
+      //! by stage, indices into the stack
+      std::vector<std::vector<std::size_t> > stages_;
+
+      boost::shared_ptr<state> state_;
+      boost::mutex state_mtx_;
+
+      boost::thread_group threads;
+
+      using scheduler::graph;
+      using scheduler::stack;
+      using scheduler::plan;
+      using scheduler::plasm;
+    };
+  }
+}
@@ -45,19 +45,65 @@ namespace ecto {
 
   namespace schedulers {
 
+    /**
+     * \brief A synchronous dataflow scheduler.
+     *
+     * Ports may declare rates (see tendril::rate).  When the stack is
+     * computed, sdf solves the balance equations for the number of times each
+     * cell fires per period (the repetition vector), works out a periodic
+     * schedule that fires downstream cells as early as possible, and works
+     * out the most values each edge holds during that schedule (buffer()).
+     * A run bounds each edge to that, with its slots allocated up front,
+     * and just replays the schedule; the edges get their own bounds back
+     * after it.
+     *
+     * A cell with a port of another rate than 1 must have a process_batch.
+     * sdf calls it once per firing, with a column of rate() values for each
+     * port (see tendrils_batch::reset_rates).
+     *
+     * An iteration is one period.  Rates that admit no repetition vector,
+     * lossy edges and bounded edges with less room than the schedule needs
+     * are rejected when the stack is computed.
+     */
     class ECTO_EXPORT sdf : public scheduler
     {
     public:
       explicit sdf(plasm_ptr);
       ~sdf();
 
+      /**
+       * \brief How many times c fires per period, 0 if c isn't scheduled
+       * (the schedule is computed by the first execute).
+       */
+      std::size_t repetitions(const cell_ptr& c) const;
+
+      /**
+       * \brief The most values the schedule holds on the edge into input of
+       * c, 0 if there is no such edge or no schedule yet.
+       */
+      std::size_t buffer(const cell_ptr& c, const std::string& input) const;
+
+      //! The firings of one period, as indices into the stack.
+      const std::vector<std::size_t>& period() const;
+
       int execute_impl(unsigned niter, unsigned nthreads, boost::asio::io_service& topserv);
 
       void stop_impl();
       void interrupt_impl();
       void wait_impl();
     private:
-      struct runner;
+      void compute_stack_impl();
+      int fire(std::size_t step);
+
+      //! by stack index
+      std::vector<std::size_t> repetitions_;
+      std::vector<std::size_t> period_;
+      //! by plan input and output
+      std::vector<unsigned> input_rates_, output_rates_;
+      //! by plan input, the most values the period holds on its edge
+      std::vector<std::size_t> buffers_;
+      //! by stack index, whether the cell fires through its process_batch
+      std::vector<bool> multirate_;
       bool interupted_;
     };
   }
@@ -41,12 +41,39 @@
 #include <ecto/util.hpp>
 #include <ecto/tendril.hpp>
 #include <boost/tuple/tuple.hpp>
-#include <map>
 #include <ecto/log.hpp>
 namespace ecto
 {
   namespace serialization
   {
+    //! The type_ops::serialize slot of each archive type.
+    template<typename Archive>
+    struct archive_index;
+
+    template<>
+    struct archive_index<boost::archive::binary_oarchive>
+    {
+      static const type_ops::archive value = type_ops::BINARY_OA;
+    };
+
+    template<>
+    struct archive_index<boost::archive::binary_iarchive>
+    {
+      static const type_ops::archive value = type_ops::BINARY_IA;
+    };
+
+    template<>
+    struct archive_index<boost::archive::text_oarchive>
+    {
+      static const type_ops::archive value = type_ops::TEXT_OA;
+    };
+
+    template<>
+    struct archive_index<boost::archive::text_iarchive>
+    {
+      static const type_ops::archive value = type_ops::TEXT_IA;
+    };
+
     template<typename T, typename Archive>
     struct writer_
     {
@@ -56,6 +83,13 @@ namespace ecto
       {
         ar << t.get<T>();
       }
+
+      //! type_ops::serialize
+      static void
+      call(void* ar, tendril& t)
+      {
+        writer_()(*static_cast<Archive*>(ar), t);
+      }
     };
 
     template<typename T, typename Archive>
@@ -69,30 +103,35 @@ namespace ecto
           t << tendril(T(), ""); //don't want to lose docs.
         ar >> t.get<T>();
       }
+
+      //! type_ops::serialize
+      static void
+      call(void* ar, tendril& t)
+      {
+        reader_()(*static_cast<Archive*>(ar), t);
+      }
     };
 
+    /**
+     * \brief The serializers for one archive type. They are kept in the
+     * type_ops of the type they serialize.
+     */
     template<typename Archive>
     struct registry: boost::noncopyable
     {
-      typedef boost::function<void(Archive&, tendril&)> serial_fn_t;
-      typedef std::map<std::string, serial_fn_t> serial_map_t;
-
+      //! Serializer is a writer_ or reader_ for Archive.
       template<typename Serializer>
       void
-      add(const Serializer& s)
+      add(const Serializer&)
       {
-        typedef typename Serializer::value_type value_type;
-        const std::string& name = name_of<value_type>();
-        serial_fn_t fnc = serial_fn_t(s);
-        add(name, fnc);
+        type_ops& t = types::of<typename Serializer::value_type>();
+        if (!t.serialize[archive_index<Archive>::value])
+          t.serialize[archive_index<Archive>::value] = &Serializer::call;
       }
 
+      //! Serialize t as the given type, throws if there is no serializer registered for it.
       void
-      add(const std::string& name, serial_fn_t fnc);
-      void
-      serialize(const std::string& key, Archive& ar, tendril& t) const;
-
-      serial_map_t serial_map;
+      serialize(const type_ops& type, Archive& ar, tendril& t) const;
 
       static registry<Archive>& instance();
 
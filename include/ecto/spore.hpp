@@ -29,6 +29,9 @@
 #pragma once
 #include <boost/shared_ptr.hpp>
 #include <boost/function/function1.hpp>
+#include <boost/mpl/if.hpp>
+#include <boost/type_traits/is_const.hpp>
+#include <boost/type_traits/remove_const.hpp>
 
 #include <ecto/util.hpp> //name_of
 #include <ecto/tendril.hpp>
@@ -40,19 +43,31 @@ namespace ecto
   /**
    * \class spore
    * \brief The spore is a typed handle for tendrils, making holding onto tendrils a bit easier.
+   *
+   * The spore keeps a raw pointer to its tendril next to the owning one, and
+   * remembers the type it last verified, so dereferencing it doesn't touch the
+   * reference count and only checks the type again if the tendril's type changed.
+   *
+   * A spore<const T> is a read only handle on a tendril of T.  Declare inputs
+   * that the cell only reads that way: dereferencing it never copies a shared
+   * payload (see tendril::shared_payload), where a spore<T> has to assume the
+   * value may be changed in place.
    */
   template<typename T>
   struct spore
   {
     typedef spore<T> this_type;
-    typedef T value_type;
+    typedef typename boost::remove_const<T>::type value_type;
     typedef T& reference_type;
     typedef T* pointer_type;
     typedef const T* const_pointer_type;
     /**
      * Allocates a spore that doesn't point to anything.
      */
-    spore() { }
+    spore()
+      : raw_(0)
+      , type_(0)
+    { }
 
     /**
      * implicit constructor from a tendril ptr. Needs to be a shared_ptr
@@ -60,13 +75,16 @@ namespace ecto
      */
     spore(tendril_ptr t) :
       tendril_(t)
+      , raw_(t.get())
+      , type_(0)
     {
       if(!t)
         BOOST_THROW_EXCEPTION(except::NullTendril()
                               << except::diag_msg("creating sport with type")
                               << except::spore_typename(name_of<T>()));
 
-      t->enforce_type<T>();
+      t->enforce_type<value_type>();
+      type_ = &t->type();
     }
 
     /**
@@ -75,7 +93,7 @@ namespace ecto
      * @param cb The callback
      * @return ref to this spore, for chaining.
      */
-    spore<T>& set_callback(typename boost::function1<void, T> cb)
+    spore<T>& set_callback(typename boost::function1<void, value_type> cb)
     {
       get()->set_callback(cb);
       return *this;
@@ -130,28 +148,68 @@ namespace ecto
       return get()->required();
     }
 
+    /**
+     * @see tendril::rewritten
+     */
+    spore<T>& rewritten(bool b)
+    {
+      get()->rewritten(b);
+      return *this;
+    }
+
+    /**
+     * @see tendril::shared_payload
+     */
+    spore<T>& shared_payload(bool b)
+    {
+      get()->shared_payload(b);
+      return *this;
+    }
+
+    /**
+     * @see tendril::rate
+     */
+    spore<T>& rate(unsigned r)
+    {
+      get()->rate(r);
+      return *this;
+    }
+
+    unsigned rate() const
+    {
+      return get()->rate();
+    }
+
     pointer_type operator->()
     {
-      tendril_ptr _p = get();
-      return &(_p->get<T>());
+      return &value();
     }
 
     const_pointer_type operator->() const
     {
-      tendril_cptr _p = get();
-      return &(_p->get<const T>());
+      return &value();
     }
 
     reference_type operator*()
     {
-      tendril_ptr _p = get();
-      return _p->get<T>();
+      return value();
+    }
+
+    /**
+     * Assign a whole new value, @see tendril::operator<<.  Unlike writing
+     * through operator*, this never copies the value a frozen output still
+     * shares with its consumers.
+     */
+    spore<T>& operator<<(const value_type& val)
+    {
+      *raw() << val;
+      return *this;
     }
 
-    const_pointer_type operator*() const
+    //! const access never copies a shared payload.
+    const T& operator*() const
     {
-      tendril_cptr _p = get();
-      return _p->get<const T>();
+      return value();
     }
 
     typedef tendril_ptr this_type::*unspecified_bool_type;
@@ -169,8 +227,7 @@ namespace ecto
      */
     inline tendril_ptr get()
     {
-      if (!tendril_)
-        BOOST_THROW_EXCEPTION(except::NullTendril());
+      raw();
       return tendril_;
     }
 
@@ -180,13 +237,59 @@ namespace ecto
      */
     inline tendril_cptr get() const
     {
-      if (!tendril_)
+      raw();
+      return tendril_;
+    }
+
+    //! get() without the shared_ptr copy, for dereferencing.
+    inline tendril* raw()
+    {
+      if (!raw_)
+        BOOST_THROW_EXCEPTION(except::NullTendril());
+      return raw_;
+    }
+
+    inline const tendril* raw() const
+    {
+      if (!raw_)
         BOOST_THROW_EXCEPTION(except::NullTendril() 
                               << except::diag_msg("access via spore")
                               << except::spore_typename(name_of<T>()));
 
-      return tendril_;
+      return raw_;
+    }
+
+    //! Re-verify the type, once, if the tendril has taken on another type since.
+    inline void check_type(const tendril& t) const
+    {
+      if (&t.type() != type_)
+      {
+        t.enforce_type<value_type>();
+        type_ = &t.type();
+      }
+    }
+
+    //! a spore<const T> reads through a const tendril, so it never thaws it.
+    typedef typename boost::mpl::if_<boost::is_const<T>, const tendril, tendril>::type tendril_type;
+
+    inline T& value()
+    {
+      tendril_type* t = raw();
+      check_type(*t);
+      return t->template unsafe_get<value_type>();
+    }
+
+    inline const T& value() const
+    {
+      const tendril* t = raw();
+      check_type(*t);
+      return t->template unsafe_get<value_type>();
     }
+
     tendril_ptr tendril_;
+    //! tendril_.get(), kept so access doesn't go through the shared_ptr
+    tendril* raw_;
+    //! the type last verified to be T
+    mutable const type_ops* type_;
   };
 }
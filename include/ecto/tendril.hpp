@@ -29,11 +29,12 @@
 #pragma once
 #include <boost/shared_ptr.hpp>
 #include <boost/function/function1.hpp>
-#define BOOST_SIGNALS2_MAX_ARGS 3
-#include <boost/signals2.hpp>
-#include <boost/any.hpp>
 
 #include <ecto/forward.hpp>
+#include <ecto/holder.hpp>
+#include <ecto/type_ops.hpp>
+#include <ecto/dirty_list.hpp>
+#include <ecto/hook.hpp>
 
 #include <ecto/util.hpp> //name_of
 #include <ecto/except.hpp>
@@ -59,6 +60,15 @@ namespace ecto
    * construct a pointer to tendril, perhaps with the make_tendril<T>() function.
    *
    * Items held by the tendril must be copy constructible and copiable.
+   *
+   * The port metadata (doc string, rate, change callbacks and dirty watchers)
+   * is kept in a descriptor.  A copy of a tendril shares the descriptor, so
+   * copying copies the value, the flags and a pointer, never the doc string;
+   * the first change to the metadata of either one gives it its own.  The
+   * callbacks and watchers stay with the tendril they were set on: a copy of
+   * a tendril that has any gets a descriptor of its own right away, with the
+   * doc string and rate but neither of those, and assigning to a tendril
+   * that has any only takes the doc string and rate of the right hand side.
    */
 
   class ECTO_EXPORT tendril
@@ -72,6 +82,8 @@ namespace ecto
       USER_SUPPLIED,
       REQUIRED,
       OPTIONAL,
+      SHARED_PAYLOAD,
+      REWRITTEN,
       N_FLAGS
     };
 
@@ -89,6 +101,14 @@ namespace ecto
     tendril(const tendril& rhs);
     tendril& operator=(const tendril& rhs);
 
+#if !defined(BOOST_NO_RVALUE_REFERENCES)
+    //! The moved from tendril holds tendril::none.
+    tendril(tendril&& rhs);
+    //! The moved from tendril is left holding our previous value, the
+    //! metadata is taken as operator=(const tendril&) does.
+    tendril& operator=(tendril&& rhs);
+#endif
+
     /**
      * \brief A convenience constructor for creating a tendril
      * that holds the given type.
@@ -99,7 +119,7 @@ namespace ecto
     template <typename T>
     tendril (const T& t, const std::string& doc)
       : flags_()
-      , converter(&ConverterImpl<T>::instance)
+      , tick(0)
     {
       flags_[DEFAULT_VALUE]=true;
       set_holder<T>(t);
@@ -115,7 +135,12 @@ namespace ecto
      */
     std::string
     type_name() const;
-    const char* type_id() const {return type_ID_;}
+
+    //! The dense id of the held type, see type_ops.
+    std::size_t type_id() const { return type_->id; }
+
+    //! The operations on the held type.
+    const type_ops& type() const { return *type_; }
 
     /**
      * \brief A doc string for this tendril, "foo is for the input
@@ -170,6 +195,10 @@ namespace ecto
       return unsafe_get<T>();
     }
 
+    /**
+     * \brief Assign a whole new value.  A frozen value is left to the tendrils
+     * that share it rather than copied on write, see freeze().
+     */
     template <typename T>
     void
     operator<<(const T& val)
@@ -180,7 +209,8 @@ namespace ecto
       }else
       {
         //throws on failure
-        get<T>() = val;
+        enforce_type<T>();
+        overwrite(val);
       }
     }
 
@@ -188,6 +218,20 @@ namespace ecto
 
     tendril& operator<<(const tendril& rhs);
 
+    /**
+     * \brief Like operator<<, but takes the value out of rhs instead of copying it.
+     * When the types match the holders are swapped, so rhs is left holding a
+     * valid value of the same type (our previous one). Otherwise this copies.
+     */
+    tendril& move_from(tendril& rhs);
+
+    /**
+     * \brief Copy only the value and tick of rhs, leaving the metadata and flags alone.
+     * Unlike operator<< there is no type check or conversion, this takes on the type of rhs.
+     * This is what the edges of the graph do with values in flight.
+     */
+    void copy_value(const tendril& rhs);
+
     /**
      * \brief runtime check if the tendril is of the given type.
      * @return true if it is the type.
@@ -196,8 +240,7 @@ namespace ecto
     bool
     is_type() const
     {
-      const char* ourname = name_of<T>().c_str();
-      return ourname == type_ID_;
+      return type_ == &types::of<T>();
     }
 
     /**
@@ -239,6 +282,11 @@ namespace ecto
 
     //! A none type for tendril when the tendril is uninitialized.
     struct none {
+#if !defined(BOOST_NO_DEFAULTED_FUNCTIONS)
+      //next to the assignments below, defaulted so that none stays inline in a holder
+      none() = default;
+      none(const none&) = default;
+#endif
       none& operator=(const none&) { return *this; }
       const none& operator=(const none&) const { return *this; } // funny const assignment operator
       friend bool operator==(const none&, const none&) { return true; }
@@ -264,10 +312,12 @@ namespace ecto
       CbT cb;
     };
 
+    typedef hook<void(tendril&)> job_signal_t;
+
     template<typename Signature>
-    boost::signals2::connection connect(Signature slot)
+    job_signal_t::connection connect(Signature slot)
     {
-      return jobs_.connect(slot);
+      return mutable_meta().jobs.connect(slot);
     }
 
     /**
@@ -285,6 +335,52 @@ namespace ecto
       return *this;
     }
 
+    /**
+     * \brief Opt in to sharing this tendril's value downstream instead of copying it.
+     *
+     * When set on an output, the scheduler freezes the value into an immutable,
+     * reference counted payload before handing it to the outgoing edges, so that
+     * every consumer receives a handle to the same value. Const access to a frozen
+     * value is free, and so is assigning a new one with operator<<, which lets go
+     * of the payload.  Only mutable access, which may change the value in place,
+     * makes a private copy first (copy on write).  Consumers read through the
+     * const path, e.g. a spore<const T> input.
+     */
+    void shared_payload(bool b);
+
+    /**
+     * \brief Declare that the owning cell assigns this output in full on every process().
+     *
+     * The scheduler may then move the value out to a single consumer instead of
+     * copying it, leaving the output holding some stale value of the same type.
+     * Don't set this on outputs the cell reads back, e.g. accumulators.
+     */
+    void rewritten(bool b);
+
+    bool rewritten() const;
+
+    bool shared_payload() const;
+
+    /**
+     * \brief The number of values the port produces (an output) or consumes
+     * (an input) each time its cell fires, 1 unless set.
+     *
+     * Only the sdf scheduler honours rates: it fires a cell with a port of rate
+     * other than 1 through its process_batch, with a column of n values for a
+     * port of rate n, all n taken off the input's edge or pushed on the output's.
+     */
+    void rate(unsigned r);
+
+    unsigned rate() const;
+
+    /**
+     * \brief Move the value into an immutable payload that copies of this tendril share.
+     */
+    void freeze();
+
+    //! The value is held in a payload that may be shared with other tendrils.
+    bool frozen() const { return payload_.get() != 0; }
+
     //! Notify the callback, only if this is dirty.
     void
     notify();
@@ -295,6 +391,7 @@ namespace ecto
     dirty() const;
 
     //! Set the tendril dirty, implying that the value has changed.
+    //! This queues it on any dirty_list watching it.
     void
     dirty(bool);
 
@@ -303,27 +400,36 @@ namespace ecto
     template<typename T>
     inline const T& unsafe_get() const
     {
-      return *boost::unsafe_any_cast<const T>(&holder_);
+      return *(payload_ ? payload_.get() : &holder_)->unsafe_get<T>();
     }
 
     template<typename T>
     inline T& unsafe_get()
     {
-      return *boost::unsafe_any_cast<T>(&holder_);
+      if (payload_)
+        thaw();
+      return *holder_.unsafe_get<T>();
     }
 
-    struct Converter
+    //! bring a frozen value back into holder_, copying it if the payload is shared.
+    void thaw();
+
+    //! replace the value with val, never copying a frozen one.
+    template<typename T>
+    void overwrite(const T& val)
     {
-      virtual void operator()(tendril& t, const boost::python::object& o) const = 0;
-      virtual void operator()(boost::python::object& o, const tendril& t) const = 0;
-    };
+      if (payload_.unique())
+        thaw(); //ours alone, and val may live in it
+      payload_.reset(); //the others that hold it keep it, and val, alive
+      holder_ = val; //in place if the stale holder holds a T
+    }
 
+    //! type_ops::from_python and type_ops::to_python for T
     template <typename T,  typename _=void>
-    struct ConverterImpl : Converter
+    struct python
     {
-      static ConverterImpl<T, _> instance;
-      void
-      operator()(tendril& t, const boost::python::object& obj) const
+      static void
+      from(tendril& t, const boost::python::object& obj)
       {
         boost::python::extract<T> get_T(obj);
         if (get_T.check())
@@ -334,8 +440,8 @@ namespace ecto
                                 << except::cpp_typename(t.type_name()));
       }
 
-      void
-      operator()(boost::python::object& o, const tendril& t) const
+      static void
+      to(boost::python::object& o, const tendril& t)
       {
         const T& v = t.get<T>();
         boost::python::object obj(v);
@@ -344,17 +450,16 @@ namespace ecto
     };
 
     template <typename _>
-    struct ConverterImpl<none, _> : Converter
+    struct python<none, _>
     {
-      static ConverterImpl<none, _> instance;
-      void
-      operator()(tendril& t, const boost::python::object& obj) const
+      static void
+      from(tendril& t, const boost::python::object& obj)
       {
         t << obj;
       }
 
-      void
-      operator()(boost::python::object& o, const tendril& t) const
+      static void
+      to(boost::python::object& o, const tendril&)
       {
         o = boost::python::object();
       }
@@ -364,18 +469,38 @@ namespace ecto
     void set_holder(const T& t = T())
     {
       holder_ = t;
-      type_ID_ = name_of<T>().c_str();
-      converter = &ConverterImpl<T>::instance;
+      payload_.reset();
+      type_ = &types::of<T>();
     }
     void copy_holder(const tendril& rhs);
 
-    boost::any holder_;
-    const char* type_ID_;
-    std::string doc_;
+    //! Per port metadata, created on first use and shared by copies of the tendril
+    //! until either changes it.  One with jobs or watchers is never shared.
+    struct meta
+    {
+      meta() : rate(1) { }
+      std::string doc;
+      unsigned rate;
+      job_signal_t jobs;
+      //! the lists this tendril is queued on when set dirty
+      std::vector<dirty_list::watcher> watchers;
+    };
+
+    //! the metadata for this tendril alone to change
+    meta& mutable_meta();
+    //! what a copy of a tendril with metadata m gets
+    static boost::shared_ptr<meta> copy_meta(const boost::shared_ptr<meta>& m);
+    //! the doc string and rate of m, without jobs or watchers
+    static boost::shared_ptr<meta> unshared(const meta& m);
+    //! take the doc string and rate of rhs, keeping our own jobs and watchers
+    void assign_meta(const tendril& rhs);
+
+    holder holder_;
+    //! when set, this holds the value and holder_ is stale.
+    boost::shared_ptr<holder> payload_;
+    const type_ops* type_;
+    boost::shared_ptr<meta> meta_;
     std::bitset<N_FLAGS> flags_;
-    typedef boost::signals2::signal<void(tendril&)> job_signal_t;
-    job_signal_t jobs_;
-    Converter* converter;
 
   public:
 
@@ -388,7 +513,7 @@ namespace ecto
 
     void operator>>(boost::python::object& obj) const
     {
-      (*converter)(obj, *this);
+      type_->to_python(obj, *this);
     }
 
     void operator>>(const tendril_ptr& rhs) const
@@ -453,6 +578,16 @@ namespace ecto
     template <typename T>
     friend tendril_ptr make_tendril();
 
+    friend struct graph::typed_slot;
+
+    template <typename T>
+    friend struct types::table;
+
+    template <typename T>
+    friend struct spore;
+
+    friend class dirty_list;
+
     std::size_t tick; // for sanity-checking
   };
 
@@ -464,13 +599,20 @@ namespace ecto
     return t;
   }
 
-  template <typename T, typename _>
-  tendril::ConverterImpl<T,_>
-  tendril::ConverterImpl<T,_>::instance;
-
-  template <typename _>
-  tendril::ConverterImpl<tendril::none,_>
-  tendril::ConverterImpl<tendril::none,_>::instance;
+  namespace types
+  {
+    template <typename T>
+    type_ops table<T>::ops =
+      {
+        &name_of<T>,
+        &tendril::python<T>::from,
+        &tendril::python<T>::to,
+        0,
+        { 0, 0, 0, 0 },
+        0,
+        0
+      };
+  }
 
 }
 
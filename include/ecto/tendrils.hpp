@@ -30,6 +30,7 @@
 #include <boost/thread.hpp>
 #include <ecto/tendril.hpp>
 #include <ecto/spore.hpp>
+#include <ecto/typed_edge.hpp>
 #include <boost/thread.hpp>
 #define BOOST_SIGNALS2_MAX_ARGS 3
 #include <boost/signals2.hpp>
@@ -37,6 +38,7 @@
 #include <sstream>
 #include <cstring>
 #include <map>
+#include <vector>
 #include <stdexcept>
 
 namespace ecto
@@ -49,12 +51,18 @@ namespace ecto
 
   /**
    * \brief The tendrils are a collection for the ecto::tendril class, addressable by a string key.
+   *
+   * Once the ports are declared the cell freezes its tendrils, after which
+   * they are also addressable by port_handle, an index into a flat array
+   * sorted by key, and lookups by key no longer take a lock.  Changing the
+   * set of keys thaws them again, invalidating any handles.
    */
   class ECTO_EXPORT tendrils : boost::noncopyable
   {
   public:
 
     typedef std::map<std::string, tendril_ptr> storage_type;
+    typedef std::size_t port_handle;
 
     typedef storage_type::iterator iterator;
     typedef storage_type::const_iterator const_iterator;
@@ -74,22 +82,24 @@ namespace ecto
     iterator find(const std::string& name) { return storage.find(name); }
     const_iterator find(const std::string& name) const { return storage.find(name); }
 
-    void clear() { storage.clear(); }
+    void clear() { thaw(); storage.clear(); }
 
     size_type size() const { return storage.size(); }
 
-    void erase(iterator pos) { storage.erase(pos); }
-    void erase(const key_type& k) { storage.erase(k); }
+    void erase(iterator pos) { thaw(); storage.erase(pos); }
+    void erase(const key_type& k) { thaw(); storage.erase(k); }
 
     template <typename InputIterator>
     void
     insert(InputIterator first, InputIterator last)
     {
+      thaw();
       storage.insert(first, last);
     }
 
     std::pair<iterator, bool> insert(const value_type &v)
     {
+      thaw();
       return storage.insert(v);
     }
 
@@ -106,6 +116,7 @@ namespace ecto
     spore<T>
     declare(const std::string& name)
     {
+      graph::typed_edge_registrar<T>::ensure();
       tendril_ptr t(make_tendril<T>());
       return declare(name, t);
     }
@@ -151,7 +162,8 @@ namespace ecto
 
       This will be called by realize_potential(cookie). Typically cookie is of type CellImplementation.
 
-     Convenience function for static registration of pointer to members that are of type spore<T>
+     Convenience function for static registration of pointer to members that are of type spore<T>,
+     or spore<const T> for a read only input, the tendril is of T either way.
      */
     template<typename T, typename CellImpl>
     spore<T>
@@ -160,7 +172,8 @@ namespace ecto
     {
       sig_t::extended_slot_type slot(spore_assign(ptm,name),_1,_2,_3);
       static_bindings_.connect_extended(slot);
-      return declare<T>(name,doc,default_val);
+      declare<typename spore<T>::value_type>(name,doc,default_val);
+      return (*this)[name];
     }
 
     template <typename Impl>
@@ -213,6 +226,24 @@ namespace ecto
 
     tendril_ptr& operator[](const std::string& name);
 
+    /**
+     * \brief Build the flat index, cell::configure does this after declare_io.
+     */
+    void freeze();
+
+    bool frozen() const { return frozen_; }
+
+    /**
+     * \brief The handle of the tendril at the key, for use with at().
+     * Throws if the key doesn't exist or the tendrils aren't frozen.
+     */
+    port_handle handle(const std::string& name) const;
+
+    //! The tendril with the given handle. No checks, no lock.
+    const tendril_ptr& at(port_handle h) const { return ports_[h]->second; }
+
+    tendril_ptr& at(port_handle h) { return ports_[h]->second; }
+
     /**
      * \brief Print the tendrils documentation string, in rst format.
      * @param out The stream to print to.
@@ -229,7 +260,15 @@ namespace ecto
     void doesnt_exist(const std::string& name) const;
     tendrils(const tendrils&);
 
+    void thaw();
+
+    //! index of the key in ports_, or ports_.size()
+    port_handle lower_bound(const std::string& name) const;
+
     storage_type storage;
+    //! the map's elements, in key order, valid while frozen_.
+    std::vector<value_type*> ports_;
+    bool frozen_;
     mutable boost::mutex mtx;
     typedef boost::signals2::signal<void(void*, const tendrils*)> sig_t;
     sig_t static_bindings_;
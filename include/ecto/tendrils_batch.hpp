@@ -0,0 +1,107 @@
+/*
+ * Copyright (c) 2011, Willow Garage, Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the Willow Garage, Inc. nor the names of its
+ *       contributors may be used to endorse or promote products derived from
+ *       this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#pragma once
+#include <ecto/forward.hpp>
+#include <ecto/util.hpp>
+#include <ecto/tendril.hpp>
+
+#include <boost/noncopyable.hpp>
+
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace ecto
+{
+  class tendrils;
+
+  /**
+   * \brief The values of a cell's ports over several ticks, what a cell's
+   * process_batch works on.
+   *
+   * Each port is a column of tendrils, one per tick, oldest first.  The
+   * columns start out as copies of the ports, so they hold values of the
+   * right type; process_batch reads its input columns and writes every tick
+   * of its output columns, which the scheduler then pushes downstream.
+   */
+  class ECTO_EXPORT tendrils_batch : boost::noncopyable
+  {
+  public:
+    typedef std::vector<tendril> column;
+
+    tendrils_batch();
+
+    /**
+     * \brief Lay out n ticks of each of the ports.  Columns already laid out
+     * for the same ports are only resized.
+     */
+    void reset(const tendrils& ports, std::size_t n);
+
+    /**
+     * \brief Lay out one firing of the ports under the sdf scheduler, each
+     * column holding as many values as the port's rate().  size() is 1.
+     */
+    void reset_rates(const tendrils& ports);
+
+    //! The number of ticks.
+    std::size_t size() const { return ticks_; }
+
+    bool has(const std::string& key) const;
+
+    //! The column of the port, throws NonExistant if there is none.
+    column& operator[](const std::string& key);
+    const column& operator[](const std::string& key) const;
+
+    //! The value of the port on the tick'th tick of the batch.
+    template <typename T>
+    const T& get(const std::string& key, std::size_t tick) const
+    {
+      return (*this)[key][tick].get<T>();
+    }
+
+    template <typename T>
+    T& get(const std::string& key, std::size_t tick)
+    {
+      return (*this)[key][tick].get<T>();
+    }
+
+  private:
+
+    //! columns_ keyed like ports, their values left as they are if they already were
+    void layout(const tendrils& ports);
+
+    //! index of the key in columns_, or columns_.size()
+    std::size_t lower_bound(const std::string& key) const;
+    std::size_t find(const std::string& key) const;
+
+    std::size_t ticks_;
+    //! sorted by key, as the tendrils are
+    std::vector<std::pair<std::string, column> > columns_;
+  };
+}
@@ -0,0 +1,120 @@
+/*
+ * Copyright (c) 2011, Willow Garage, Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the Willow Garage, Inc. nor the names of its
+ *       contributors may be used to endorse or promote products derived from
+ *       this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#pragma once
+#include <ecto/util.hpp>
+
+#include <boost/function.hpp>
+#include <boost/noncopyable.hpp>
+#include <boost/shared_ptr.hpp>
+
+#include <vector>
+
+namespace ecto
+{
+  /**
+   * \brief Warm threads that schedulers borrow for one execute() instead of
+   * creating their own.
+   *
+   * The threads of a pool are started once and wait between jobs, so many
+   * short execute() calls, or schedulers run from inside a cell's process()
+   * (BlackBox, Executer), cost no thread creation.  A crew takes only idle
+   * threads, so plasms executing at once share shared()'s threads rather
+   * than oversubscribing the machine.
+   */
+  class ECTO_EXPORT thread_pool : boost::noncopyable
+  {
+    struct impl;
+
+  public:
+    //! What each borrowed thread runs, with its index in the crew.
+    typedef boost::function<void(unsigned)> job;
+
+    //! nthread threads, one per logical cpu if 0.
+    explicit thread_pool(unsigned nthread = 0);
+
+    //! Waits for the running jobs, then stops the threads.
+    ~thread_pool();
+
+    /**
+     * \brief The process wide pool, one thread per cpu this process may run
+     * on, or ECTO_POOL_THREADS.  Never destroyed, so that threads still
+     * running at exit aren't joined.
+     */
+    static thread_pool& shared();
+
+    unsigned size() const;
+
+    //! The threads not lent to any crew at the moment.
+    unsigned idle() const;
+
+    /**
+     * \brief Threads of a pool running one job, returned to it on join().
+     *
+     * The crew gets as many of the n threads asked for as are idle.  When
+     * every thread of the pool is lent (a scheduler run from inside
+     * another) it gets none, and j(0) runs on the thread that joins it
+     * instead, which would otherwise only wait.  A pool of fewer than n
+     * threads grows to n first.
+     */
+    class ECTO_EXPORT crew : boost::noncopyable
+    {
+    public:
+      /**
+       * \brief Run j(0) .. j(size() - 1) on threads of pool.  A thread
+       * whose cpus[i] is not negative is pinned to it while it runs j(i).
+       */
+      crew(thread_pool& pool, unsigned n, const job& j,
+           const std::vector<int>& cpus = std::vector<int>());
+
+      //! Joins.
+      ~crew();
+
+      //! How many threads the crew got, 1 if its job is deferred.
+      unsigned size() const;
+
+      //! The crew got no thread, j(0) is yet to run in join().
+      bool deferred() const;
+
+      //! Run j(0) if it is deferred, then wait for every thread of the crew to return from its job.
+      void join();
+
+      //! Interrupt the pool threads still running the job, not a thread running it in join().
+      void interrupt();
+
+      struct impl;
+
+    private:
+      boost::shared_ptr<thread_pool::impl> pool_;
+      boost::shared_ptr<impl> impl_;
+    };
+
+  private:
+    boost::shared_ptr<impl> impl_;
+  };
+}
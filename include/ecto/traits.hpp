@@ -35,6 +35,9 @@ namespace ecto {
   namespace detail {
     template <typename T> struct is_threadsafe : boost::mpl::true_ { };
 
+    //! whether each instance of a thread unsafe T gets a strand of its own
+    template <typename T> struct unsafe_per_instance : boost::mpl::false_ { };
+
     template <typename T> struct python_mutex 
     { 
       typedef ecto::py::nothing_to_lock type; 
@@ -51,6 +54,15 @@ namespace ecto {
   }                                                                     \
 
 
+#define ECTO_THREAD_UNSAFE_PER_INSTANCE(T)                              \
+  namespace ecto {                                                      \
+    namespace detail {                                                  \
+      template <> struct is_threadsafe<T> : boost::mpl::false_ { };     \
+      template <> struct unsafe_per_instance<T> : boost::mpl::true_ { }; \
+    }                                                                   \
+  }                                                                     \
+
+
 #define ECTO_NEEDS_PYTHON_GIL(T)                                        \
   namespace ecto {                                                      \
     namespace detail {                                                  \
@@ -0,0 +1,139 @@
+/*
+ * Copyright (c) 2011, Willow Garage, Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the Willow Garage, Inc. nor the names of its
+ *       contributors may be used to endorse or promote products derived from
+ *       this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#pragma once
+#include <ecto/forward.hpp>
+#include <ecto/util.hpp>
+#include <ecto/atomic.hpp>
+
+#include <boost/python/object_fwd.hpp>
+
+#include <iosfwd>
+#include <string>
+
+namespace ecto
+{
+  /**
+   * \brief The operations on one type of value that a tendril can hold.
+   *
+   * There is one type_ops per type, process wide, interned by type name and
+   * numbered densely from 1, so tables keyed on type can be plain arrays.
+   * A tendril points at the type_ops of its value, which makes printing,
+   * python conversion, serialization and picking an edge queue a call through
+   * a function pointer instead of a lookup by name.  Copying and moving the
+   * value itself is done by the tendril's holder.
+   */
+  struct type_ops
+  {
+    //! The archives that values can be serialized with, see serialization/registry.hpp
+    enum archive
+    {
+      BINARY_OA,
+      BINARY_IA,
+      TEXT_OA,
+      TEXT_IA,
+      N_ARCHIVES
+    };
+
+    typedef void (*print_fn)(std::ostream& out, const tendril& t);
+    typedef void (*from_python_fn)(tendril& t, const boost::python::api::object& o);
+    typedef void (*to_python_fn)(boost::python::api::object& o, const tendril& t);
+    //! archive points at the archive type of the slot this is stored in.
+    typedef void (*serialize_fn)(void* archive, tendril& t);
+    //! argument is a graph::edge::queue_type
+    typedef graph::queue_base* (*queue_fn)(unsigned q);
+
+    //! The unmangled type name, e.g. "double" or "cv::Mat"
+    const std::string& (*name)();
+    from_python_fn from_python;
+    to_python_fn to_python;
+    //! 0 if values of this type aren't printable
+    print_fn print;
+    //! 0 where no serializer is registered, see ECTO_REGISTER_SERIALIZERS
+    serialize_fn serialize[N_ARCHIVES];
+    //! makes an edge queue that stores the type directly, 0 if there is none.
+    //! Set at most once, read it with load_acquire.
+    volatile queue_fn make_queue;
+    //! 0 until interned
+    std::size_t id;
+  };
+
+  namespace types
+  {
+    /**
+     * \brief Number ops, and return the canonical type_ops for its type name.
+     *
+     * A type instantiated in more than one shared library may have a type_ops
+     * in each, the first one interned is canonical and the rest share its id.
+     */
+    ECTO_EXPORT type_ops* intern(type_ops& ops);
+
+    //! The canonical type_ops with the given id, 0 if there is none. Doesn't lock.
+    ECTO_EXPORT type_ops* by_id(std::size_t id);
+
+    //! The canonical type_ops for the unmangled type name, 0 if there is none.
+    ECTO_EXPORT type_ops* by_name(const std::string& name);
+
+    //! One past the largest id handed out so far.
+    ECTO_EXPORT std::size_t end_id();
+
+    template<typename T>
+    struct table
+    {
+      //! constant initialized, so it can be used during static initialization
+      static type_ops ops;
+      //! what intern returned for ops, published with store_release
+      static type_ops* volatile canonical;
+    };
+
+    template<typename T>
+    type_ops* volatile table<T>::canonical = 0;
+
+    //! The type_ops of T, interning it on first use. See tendril.hpp for table<T>::ops.
+    template<typename T>
+    inline type_ops&
+    of()
+    {
+      type_ops* t = load_acquire(table<T>::canonical);
+      if (!t)
+      {
+        //intern locks, racing threads get the same answer
+        t = intern(table<T>::ops);
+        store_release(table<T>::canonical, t);
+      }
+      return *t;
+    }
+
+    template<typename T>
+    inline std::size_t
+    id_of()
+    {
+      return of<T>().id;
+    }
+  }
+}
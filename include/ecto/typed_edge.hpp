@@ -0,0 +1,75 @@
+/*
+ * Copyright (c) 2011, Willow Garage, Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the Willow Garage, Inc. nor the names of its
+ *       contributors may be used to endorse or promote products derived from
+ *       this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#pragma once
+
+#include <ecto/tendril.hpp>
+#include <ecto/type_ops.hpp>
+#include <ecto/atomic.hpp>
+
+#include <boost/python/object_fwd.hpp>
+
+namespace ecto {
+  namespace graph {
+
+    /**
+     * \brief type_ops::make_queue for every type that has one: a queue of
+     * slots that hold the value directly, without a tendril around it.
+     * The queues themselves are private to the library, see edge.cpp.
+     */
+    ECTO_EXPORT queue_base* make_typed_queue(unsigned q);
+
+    /**
+     * \brief Sets the typed queue of T in its type_ops. tendrils::declare calls this for
+     * every port type, tendril::none and boost::python::object ports always use
+     * the type erased queue.
+     */
+    template<typename T>
+    struct typed_edge_registrar
+    {
+      static void ensure()
+      {
+        type_ops& t = types::of<T>();
+        if (!load_acquire(t.make_queue))
+          compare_and_swap(t.make_queue, type_ops::queue_fn(0), &make_typed_queue);
+      }
+    };
+
+    template<>
+    struct typed_edge_registrar<tendril::none>
+    {
+      static void ensure() { }
+    };
+
+    template<>
+    struct typed_edge_registrar<boost::python::object>
+    {
+      static void ensure() { }
+    };
+  }
+}
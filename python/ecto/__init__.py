@@ -116,6 +116,12 @@ def cell_name(self):
 def cell_typename(self):
     return self.__impl.typename()
 
+def cell_get_priority(self):
+    return self.__impl.priority
+
+def cell_set_priority(self, p):
+    self.__impl.priority = p
+
 def cell_doc(short_doc, c):
     doc =short_doc + "\n\n"
     params = cell_print_tendrils(c.params)
@@ -150,6 +156,7 @@ def postregister(cellname, cpptypename, short_doc, inmodule):
                          configure = cell_configure,
                          name = cell_name,
                          type_name = cell_typename,
+                         priority = property(cell_get_priority, cell_set_priority),
                          __factory = e.construct,
                          __looks_like_a_cell__ = True
                          ))
@@ -141,6 +141,9 @@ class BlackBox(object):
     
     Users should inherit from BlackBox, and likely will wish to implement a few functions that
     describe their reusable plasm.
+
+    A BlackBox with niter=1 (the default) runs its plasm once per tick, the outer plasm's
+    flatten() may then splice its cells in its place, so they are scheduled with the others.
     '''
 
     def __init__(self, *args, **kwargs):
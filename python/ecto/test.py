@@ -31,6 +31,8 @@ import ecto, os
 schedulers = [
     ecto.schedulers.Multithreaded,
     ecto.schedulers.Singlethreaded,
+    ecto.schedulers.Dataflow,
+    ecto.schedulers.Pipelined,
     ]
 
 stress_test = 'ECTO_STRESS_TEST_ITERATIONS' in os.environ
@@ -0,0 +1,150 @@
+//
+// Copyright (c) 2011, Willow Garage, Inc.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//     * Neither the name of the Willow Garage, Inc. nor the names of its
+//       contributors may be used to endorse or promote products derived from
+//       this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+#include <ecto/affinity.hpp>
+
+#include <boost/lexical_cast.hpp>
+#include <boost/thread.hpp>
+
+#include <algorithm>
+#include <cctype>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <set>
+#include <string>
+#include <utility>
+
+#if defined(__linux__)
+#include <dirent.h>
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+namespace ecto
+{
+  namespace affinity
+  {
+    namespace
+    {
+      std::string cpu_dir(unsigned cpu)
+      {
+        return "/sys/devices/system/cpu/cpu" + boost::lexical_cast<std::string>(cpu);
+      }
+
+      //! the integer in a sysfs file, -1 if there is none
+      int read_int(const std::string& path)
+      {
+        std::ifstream f(path.c_str());
+        int v = -1;
+        if (!(f >> v))
+          return -1;
+        return v;
+      }
+    }
+
+    std::vector<unsigned> cpus()
+    {
+      std::vector<unsigned> c;
+#if defined(__linux__)
+      cpu_set_t set;
+      CPU_ZERO(&set);
+      if (sched_getaffinity(0, sizeof(set), &set) == 0)
+        for (unsigned j = 0; j < CPU_SETSIZE; ++j)
+          if (CPU_ISSET(j, &set))
+            c.push_back(j);
+#endif
+      if (c.empty())
+        for (unsigned j = 0; j < std::max(boost::thread::hardware_concurrency(), 1u); ++j)
+          c.push_back(j);
+      return c;
+    }
+
+    std::vector<unsigned> physical_cores()
+    {
+      std::vector<unsigned> all = cpus(), c;
+      std::set<std::pair<int, int> > seen;
+      for (std::size_t j = 0; j < all.size(); ++j)
+      {
+        std::string dir = cpu_dir(all[j]);
+        int package = read_int(dir + "/topology/physical_package_id"),
+          core = read_int(dir + "/topology/core_id");
+        if (core < 0 || seen.insert(std::make_pair(package, core)).second)
+          c.push_back(all[j]);
+      }
+      return c;
+    }
+
+    int node_of(unsigned cpu)
+    {
+      int node = 0;
+#if defined(__linux__)
+      DIR* d = opendir(cpu_dir(cpu).c_str());
+      if (!d)
+        return node;
+      while (dirent* e = readdir(d))
+        if (std::strncmp(e->d_name, "node", 4) == 0 && std::isdigit(e->d_name[4]))
+        {
+          node = std::atoi(e->d_name + 4);
+          break;
+        }
+      closedir(d);
+#endif
+      return node;
+    }
+
+    bool pin(unsigned cpu)
+    {
+#if defined(__linux__)
+      if (cpu >= CPU_SETSIZE)
+        return false;
+      cpu_set_t set;
+      CPU_ZERO(&set);
+      CPU_SET(cpu, &set);
+      return pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+#else
+      return false;
+#endif
+    }
+
+    bool pin(const std::vector<unsigned>& cpus)
+    {
+#if defined(__linux__)
+      cpu_set_t set;
+      CPU_ZERO(&set);
+      for (std::size_t j = 0; j < cpus.size(); ++j)
+        if (cpus[j] < CPU_SETSIZE)
+          CPU_SET(cpus[j], &set);
+      if (CPU_COUNT(&set) == 0)
+        return false;
+      return pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+#else
+      return false;
+#endif
+    }
+  }
+}
@@ -43,12 +43,20 @@
 /*
  * Catch all and pass on exception.
  */
-#define CATCH_ALL()                                                     \
+#define CATCH_ALL() CATCH_ALL_AS(__FUNCTION__)
+
+#define CATCH_ALL_AS(FUNCTION)                                          \
   catch (const boost::thread_interrupted&)                              \
     {                                                                   \
       ECTO_TRACE_EXCEPTION("const boost::thread_interrupted&");         \
       throw;                                                            \
     }                                                                   \
+  CATCH_ALL_BUT_INTERRUPT_AS(FUNCTION)
+
+/*
+ * The same, for callers that catch boost::thread_interrupted themselves.
+ */
+#define CATCH_ALL_BUT_INTERRUPT_AS(FUNCTION)                            \
   catch (ecto::except::NonExistant& e)                                  \
     {                                                                   \
       ECTO_TRACE_EXCEPTION("const ecto::except::NonExistant&");         \
@@ -58,7 +66,7 @@
       e << except::hint(auto_suggest(*key, *this))                      \
         << except::cell_name(name())                                    \
         << except::cell_type(type())                               \
-        << except::function_name(__FUNCTION__)                          \
+        << except::function_name(FUNCTION)                          \
         ;                                                               \
       throw;                                                            \
     }                                                                   \
@@ -67,7 +75,7 @@
       ECTO_TRACE_EXCEPTION("const ecto::except::EctoException&");       \
       e << except::cell_name(name())                                    \
         << except::cell_type(type())                               \
-        << except::function_name(__FUNCTION__)                          \
+        << except::function_name(FUNCTION)                          \
         ;                                                               \
       throw;                                                            \
     }                                                                   \
@@ -79,7 +87,7 @@
                             << except::what(e.what())                   \
                             << except::cell_name(name())                \
                             << except::cell_type(type())           \
-                            << except::function_name(__FUNCTION__))     \
+                            << except::function_name(FUNCTION))     \
         ;                                                               \
     }                                                                   \
   catch(const boost::python::error_already_set&)                        \
@@ -94,7 +102,7 @@
                             << except::what("(unknown exception)")      \
                             << except::cell_name(name())                \
                             << except::cell_type(type())           \
-                            << except::function_name(__FUNCTION__))     \
+                            << except::function_name(FUNCTION))     \
         ;                                                               \
     }
 
@@ -140,6 +148,9 @@ case ecto::NAME: {static std::string x = BOOST_PP_STRINGIZE(ecto::NAME); return
 
   cell::cell()
   : configured(false)
+  , running_(false)
+  , priority_(0)
+  , dirty_params_(new dirty_list)
   , tick_(0)
   {
     //    bsig_process.connect(&sample_siggy);
@@ -173,6 +184,12 @@ case ecto::NAME: {static std::string x = BOOST_PP_STRINGIZE(ecto::NAME); return
     configured = true;
 
     init();
+    //the ports are all declared by now.
+    parameters.freeze();
+    inputs.freeze();
+    outputs.freeze();
+    for (tendrils::iterator it = parameters.begin(); it != parameters.end(); ++it)
+      dirty_params_->watch(it->second);
     try
     {
       dispatch_configure(parameters, inputs, outputs);
@@ -192,6 +209,7 @@ case ecto::NAME: {static std::string x = BOOST_PP_STRINGIZE(ecto::NAME); return
   {
     ECTO_LOG_DEBUG("*** %s", "notified of start");
     stop_requested(false);
+    running_ = false;
     dispatch_start();
   }
 
@@ -199,9 +217,29 @@ case ecto::NAME: {static std::string x = BOOST_PP_STRINGIZE(ecto::NAME); return
   cell::stop()
   {
     ECTO_LOG_DEBUG("*** %s", "notified of stop");
+    running_ = false;
     dispatch_stop();
   }
 
+  void
+  cell::notify_params()
+  {
+    //trigger the change callbacks of the parameters that changed...
+    try
+    {
+      dirty_params_->notify();
+    } catch (const std::exception& e)
+    {
+      ECTO_TRACE_EXCEPTION("const std::exception& outside of CATCH ALL");
+      BOOST_THROW_EXCEPTION(except::CellException()
+                            << except::type(name_of(typeid(e)))
+                            << except::what(e.what())
+                            << except::cell_name(name())
+                            << except::function_name("process")
+                            << except::when("While triggering param change callbacks"))
+        ;
+    }
+  }
 
   ReturnCode
   cell::process()
@@ -212,27 +250,8 @@ case ecto::NAME: {static std::string x = BOOST_PP_STRINGIZE(ecto::NAME); return
 #endif
 
     configure();
-    //trigger all parameter change callbacks...
-    tendrils::iterator begin = parameters.begin(), end = parameters.end();
-
-    while (begin != end)
-    {
-      try
-      {
-        begin->second->notify();
-      } catch (const std::exception& e)
-      {
-        ECTO_TRACE_EXCEPTION("const std::exception& outside of CATCH ALL");
-        BOOST_THROW_EXCEPTION(except::CellException()
-                              << except::type(name_of(typeid(e)))
-                              << except::what(e.what())
-                              << except::cell_name(name())
-                              << except::function_name(__FUNCTION__)
-                              << except::when("While triggering param change callbacks"))
-          ;
-      }
-      ++begin;
-    }
+    if (!dirty_params_->empty())
+      notify_params();
     try
     {
       try
@@ -252,6 +271,149 @@ case ecto::NAME: {static std::string x = BOOST_PP_STRINGIZE(ecto::NAME); return
     } CATCH_ALL()
   }
 
+  ReturnCode
+  cell::process_running()
+  {
+#if defined(ECTO_STRESS_TEST)
+    boost::mutex::scoped_try_lock process_lock(process_mtx);
+    ECTO_ASSERT(process_lock.owns_lock(), "process() method of cell run concurrently");
+#endif
+
+    begin_process();
+
+    ReturnCode r;
+    try
+    {
+      profile::stats_collector coll(running_name_, stats);
+      bsig_process(*this, true);
+      r = dispatch_process(inputs, outputs);
+    } catch (...) {
+      return process_failed();
+    }
+    bsig_process(*this, false);
+    return r;
+  }
+
+  bool
+  cell::async() const
+  {
+    return dispatch_async();
+  }
+
+  ReturnCode
+  cell::process_async(const completion& c)
+  {
+#if defined(ECTO_STRESS_TEST)
+    boost::mutex::scoped_try_lock process_lock(process_mtx);
+    ECTO_ASSERT(process_lock.owns_lock(), "process() method of cell run concurrently");
+#endif
+
+    begin_process();
+
+    //the client's error reaches the scheduler as from process_running()
+    completion done(c.service(), boost::bind(&cell::process_async_done, this, c, _1, _2));
+    ReturnCode r;
+    try
+    {
+      profile::stats_collector coll(running_name_, stats);
+      bsig_process(*this, true);
+      r = dispatch_process_async(inputs, outputs, done);
+    } catch (...) {
+      r = process_failed(); //throws, unless interrupted
+      c(r);
+      return r;
+    }
+    bsig_process(*this, false);
+    if (r != OK)
+      done(r);
+    return r;
+  }
+
+  void
+  cell::process_async_done(const completion& c, int rval, const boost::exception_ptr& e)
+  {
+    if (!e)
+      {
+        c(rval);
+        return;
+      }
+    try
+    {
+      try
+      {
+        boost::rethrow_exception(e);
+      } catch (...) {
+        c(process_failed());
+      }
+    } catch (...) {
+      c.fail(boost::current_exception());
+    }
+  }
+
+  bool
+  cell::batched() const
+  {
+    return dispatch_batched();
+  }
+
+  plasm_ptr
+  cell::subgraph() const
+  {
+    return dispatch_subgraph();
+  }
+
+  ReturnCode
+  cell::process_batch(const tendrils_batch& in, tendrils_batch& out, std::size_t n)
+  {
+#if defined(ECTO_STRESS_TEST)
+    boost::mutex::scoped_try_lock process_lock(process_mtx);
+    ECTO_ASSERT(process_lock.owns_lock(), "process() method of cell run concurrently");
+#endif
+
+    begin_process();
+
+    ReturnCode r;
+    try
+    {
+      profile::stats_collector coll(running_name_, stats);
+      stats.ncalls += n - 1; //one per tick, as process() counts them
+      bsig_process(*this, true);
+      r = dispatch_process_batch(in, out, n);
+    } catch (...) {
+      return process_failed();
+    }
+    bsig_process(*this, false);
+    return r;
+  }
+
+  void
+  cell::begin_process()
+  {
+    if (!running_)
+    {
+      //first tick since start(): edges never unset user_supplied, so the
+      //inputs that pass now pass for the rest of the run.
+      configure();
+      verify_inputs();
+      running_name_ = name();
+      running_ = true;
+    }
+    if (!dirty_params_->empty())
+      notify_params();
+  }
+
+  ReturnCode
+  cell::process_failed()
+  {
+    try
+    {
+      throw;
+    } catch (const boost::thread_interrupted&) {
+      ECTO_TRACE_EXCEPTION("const boost::thread_interrupted&, returning QUIT instead of rethrow");
+      return ecto::QUIT;
+    } CATCH_ALL_BUT_INTERRUPT_AS("process")
+  }
+
   std::string
   cell::type() const
   {
@@ -276,6 +438,18 @@ case ecto::NAME: {static std::string x = BOOST_PP_STRINGIZE(ecto::NAME); return
     dispatch_short_doc(short_doc);
   }
 
+  int
+  cell::priority() const
+  {
+    return priority_;
+  }
+
+  void
+  cell::priority(int p)
+  {
+    priority_ = p;
+  }
+
   std::string
   cell::short_doc() const
   {
@@ -359,6 +533,11 @@ case ecto::NAME: {static std::string x = BOOST_PP_STRINGIZE(ecto::NAME); return
     return tick_;
   }
 
+  void cell::tick(std::size_t t)
+  {
+    tick_ = t;
+  }
+
   void cell::inc_tick()
   {
     ++tick_;
@@ -0,0 +1,123 @@
+//
+// Copyright (c) 2011, Willow Garage, Inc.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//     * Neither the name of the Willow Garage, Inc. nor the names of its
+//       contributors may be used to endorse or promote products derived from
+//       this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+#include <ecto/completion.hpp>
+#include <ecto/atomic.hpp>
+
+#include <boost/bind.hpp>
+
+namespace ecto
+{
+  struct completion::impl
+  {
+    impl(boost::asio::io_service& s_, const handler& h_)
+      : s(s_), h(h_), done(0)
+    { }
+
+    //! true for the first caller only
+    bool claim()
+    {
+      return compare_and_swap(done, 0, 1) == 0;
+    }
+
+    boost::asio::io_service& s;
+    handler h;
+    volatile int done;
+  };
+
+  completion::completion(boost::asio::io_service& s, const handler& h)
+    : impl_(new impl(s, h))
+  { }
+
+  void
+  completion::operator()(int rval) const
+  {
+    if (impl_->claim())
+      impl_->h(rval, boost::exception_ptr());
+  }
+
+  void
+  completion::fail(const boost::exception_ptr& e) const
+  {
+    if (impl_->claim())
+      impl_->h(0, e);
+  }
+
+  bool
+  completion::done() const
+  {
+    return load_acquire(impl_->done) != 0;
+  }
+
+  boost::asio::io_service&
+  completion::service() const
+  {
+    return impl_->s;
+  }
+
+  namespace
+  {
+    struct outcome
+    {
+      outcome() : finished(false), rval(0) { }
+
+      void set(boost::asio::io_service& s, int r, const boost::exception_ptr& e)
+      {
+        rval = r;
+        error = e;
+        //wake run_one up, the handler runs in the waiting thread.
+        s.post(boost::bind(&outcome::finish, this));
+      }
+
+      void finish()
+      {
+        finished = true;
+      }
+
+      bool finished;
+      int rval;
+      boost::exception_ptr error;
+    };
+  }
+
+  int
+  wait_for(const boost::function<int(const completion&)>& start)
+  {
+    boost::asio::io_service s;
+    outcome o;
+    completion c(s, boost::bind(&outcome::set, &o, boost::ref(s), _1, _2));
+    int rval = start(c);
+    if (rval != 0)
+      c(rval); //it didn't start, no other call is coming
+    boost::asio::io_service::work work(s);
+    while (!o.finished)
+      s.run_one();
+    if (o.error)
+      boost::rethrow_exception(o.error);
+    return o.rval;
+  }
+}
@@ -0,0 +1,118 @@
+// 
+// Copyright (c) 2011, Willow Garage, Inc.
+// All rights reserved.
+// 
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//     * Neither the name of the Willow Garage, Inc. nor the names of its
+//       contributors may be used to endorse or promote products derived from
+//       this software without specific prior written permission.
+// 
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+// 
+#include <ecto/dirty_list.hpp>
+#include <ecto/tendril.hpp>
+#include <ecto/atomic.hpp>
+
+namespace ecto
+{
+  //
+  //  A Treiber stack.  Any thread pushes, one thread at a time takes the
+  //  whole stack, so there is no ABA.  A node's queued flag keeps it from
+  //  being on the stack twice.
+  //
+  dirty_list::dirty_list()
+    : head_(0)
+  { }
+
+  dirty_list::~dirty_list()
+  {
+    for (std::size_t i = 0; i < nodes_.size(); ++i)
+      delete nodes_[i];
+  }
+
+  void
+  dirty_list::watch(const tendril_ptr& t)
+  {
+    node* n = new node;
+    n->t = t;
+    n->next = 0;
+    n->queued = 0;
+    nodes_.push_back(n);
+    watcher w = { shared_from_this(), n };
+    t->mutable_meta().watchers.push_back(w);
+    if (t->dirty())
+      push(n);
+  }
+
+  bool
+  dirty_list::empty() const
+  {
+    return load_acquire(head_) == 0;
+  }
+
+  void
+  dirty_list::push(node* n)
+  {
+    if (compare_and_swap(n->queued, 0, 1) != 0)
+      return;
+    n->next = 0;
+    link(n);
+  }
+
+  void
+  dirty_list::link(node* first)
+  {
+    node* last = first;
+    while (last->next)
+      last = last->next;
+    node* head;
+    do
+    {
+      head = load_acquire(head_);
+      last->next = head;
+    } while (compare_and_swap(head_, head, first) != head);
+  }
+
+  void
+  dirty_list::notify()
+  {
+    node* n;
+    do
+    {
+      n = load_acquire(head_);
+    } while (n && compare_and_swap(head_, n, static_cast<node*>(0)) != n);
+
+    while (n)
+    {
+      node* next = n->next;
+      //from here on a new change queues it again.
+      store_release(n->queued, 0);
+      try
+      {
+        n->t->notify();
+      } catch (...)
+      {
+        if (next)
+          link(next);
+        throw;
+      }
+      n = next;
+    }
+  }
+}
@@ -0,0 +1,472 @@
+/*
+ * Copyright (c) 2011, Willow Garage, Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the Willow Garage, Inc. nor the names of its
+ *       contributors may be used to endorse or promote products derived from
+ *       this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#pragma once
+
+#include <ecto/tendril.hpp>
+#include <ecto/edge.hpp>
+#include <ecto/atomic.hpp>
+
+#include <boost/thread/mutex.hpp>
+#include <boost/shared_ptr.hpp>
+#include <boost/noncopyable.hpp>
+
+#include <algorithm>
+#include <vector>
+
+namespace ecto {
+  namespace graph {
+
+    //
+    //  The queues behind graph::edge, private to the library.  Which port
+    //  types get a typed queue is up to typed_edge_registrar.
+    //
+    struct queue_base : boost::noncopyable
+    {
+      virtual ~queue_base() { }
+      virtual tendril& front() = 0;
+      //! the tick of the front value, without handing the value out.
+      virtual std::size_t front_tick() = 0;
+      virtual void pop_front() = 0;
+      //! move the front value into t, see tendril::move_from, and pop it.
+      virtual void take_front(tendril& t) = 0;
+      virtual void push_back(const tendril& t) = 0;
+      virtual void move_back(tendril& t) = 0;
+      virtual std::size_t size() = 0;
+      //! preallocate the slots for n values, so that holding n doesn't grow the queue.
+      virtual void reserve(std::size_t n) = 0;
+    };
+
+    //! let go of a frozen value a slot is done with, so that thaw() can tell who else holds it.
+    inline void release(tendril& t)
+    {
+      if (t.frozen())
+        t = tendril();
+    }
+
+    //! A slot of a type erased queue, it holds a whole tendril.
+    struct erased_slot
+    {
+      tendril value;
+
+      tendril& front(tendril&) { return value; }
+      std::size_t front_tick() const { return value.tick; }
+      void assign(const tendril& t) { value.copy_value(t); }
+      void steal(tendril& t) { value.move_from(t); }
+      void give(tendril& t) { t.move_from(value); }
+      void clear() { release(value); }
+    };
+
+    //
+    //  A slot of a typed queue, it holds the value's holder, type and tick,
+    //  but none of the tendril around them.  A value of the type last held
+    //  is assigned in place, or swapped in and out, so a steady stream of
+    //  one type doesn't allocate.  The ports on both ends held the edge's
+    //  type when it was connected, but a port may take on another type
+    //  since (see tendril::copy_value), so nothing is cast here: a value of
+    //  any type is held as it is, and converted, or refused with
+    //  TypeMismatch, on its way into the input by tendril::move_from, as on
+    //  a type erased edge.  A frozen value is held in shared, as a handle
+    //  to its payload.
+    //
+    struct typed_slot
+    {
+      typed_slot()
+        : type(0)
+        , tick(0)
+        , erased(false)
+      { }
+
+      //! front() is for inspection, it hands out a copy of an unshared value.
+      tendril& front(tendril& scratch)
+      {
+        if (erased)
+          return shared;
+        scratch.payload_.reset();
+        scratch.holder_ = value;
+        scratch.type_ = type;
+        scratch.tick = tick;
+        return scratch;
+      }
+
+      std::size_t front_tick() const { return tick; }
+
+      void assign(const tendril& t)
+      {
+        erased = t.frozen();
+        if (erased)
+        {
+          shared.copy_value(t);
+        }
+        else
+        {
+          value = t.holder_;
+          type = t.type_;
+        }
+        tick = t.tick;
+      }
+
+      void steal(tendril& t)
+      {
+        //swapping holders of different types would retype the port
+        if (t.frozen() || t.type_ != type)
+        {
+          assign(t);
+          return;
+        }
+        value.swap(t.holder_);
+        tick = t.tick;
+        erased = false;
+      }
+
+      void give(tendril& t)
+      {
+        if (!erased)
+        {
+          //shared is stale unless erased, the value moves there
+          shared.holder_.swap(value);
+          std::swap(shared.type_, type);
+          shared.tick = tick;
+          erased = true;
+        }
+        t.move_from(shared);
+      }
+
+      void clear() { release(shared); }
+
+      holder value;
+      const type_ops* type;
+      tendril shared;
+      std::size_t tick;
+      //! the value is in shared
+      bool erased;
+    };
+
+    //
+    //  A growable circular buffer of preconstructed slots.  Values are
+    //  assigned into recycled slots, so once the buffer has grown to its
+    //  working size and the types going by are fixed, pushing and popping
+    //  doesn't allocate.  Slots are held by pointer so that growing doesn't
+    //  invalidate a reference handed out by front().  Only the value and
+    //  tick are copied in, the slots never see the producer's metadata.
+    //
+    template<typename Slot>
+    struct slot_pool
+    {
+      typedef boost::shared_ptr<Slot> slot_ptr;
+
+      slot_pool()
+        : head(0)
+        , count(0)
+      { }
+
+      Slot& front()
+      {
+        return *slots[head];
+      }
+
+      void pop_front()
+      {
+        slots[head]->clear();
+        head = (head + 1) % slots.size();
+        --count;
+      }
+
+      Slot& back()
+      {
+        if (count == slots.size())
+          grow();
+        return *slots[(head + count) % slots.size()];
+      }
+
+      //! call after filling in back()
+      void pushed()
+      {
+        ++count;
+      }
+
+      std::size_t size() const
+      {
+        return count;
+      }
+
+      void reserve(std::size_t n)
+      {
+        if (n > slots.size())
+          grow(n);
+      }
+
+    private:
+
+      void grow(std::size_t n = 0)
+      {
+        std::vector<slot_ptr> bigger;
+        bigger.reserve(std::max<std::size_t>(std::max<std::size_t>(4, slots.size() * 2), n));
+        for (std::size_t j = 0; j < slots.size(); ++j)
+          bigger.push_back(slots[(head + j) % slots.size()]);
+        while (bigger.size() < bigger.capacity())
+          bigger.push_back(slot_ptr(new Slot));
+        slots.swap(bigger);
+        head = 0;
+      }
+
+      std::vector<slot_ptr> slots;
+      std::size_t head, count;
+    };
+
+    template<typename Slot>
+    struct deque_queue : queue_base
+    {
+      tendril& front()
+      {
+        boost::unique_lock<boost::mutex> lock(mtx);
+        return pool.front().front(scratch);
+      }
+
+      std::size_t front_tick()
+      {
+        boost::unique_lock<boost::mutex> lock(mtx);
+        return pool.front().front_tick();
+      }
+
+      void pop_front()
+      {
+        boost::unique_lock<boost::mutex> lock(mtx);
+        pool.pop_front();
+      }
+
+      void take_front(tendril& t)
+      {
+        boost::unique_lock<boost::mutex> lock(mtx);
+        pool.front().give(t);
+        pool.pop_front();
+      }
+
+      void push_back(const tendril& t)
+      {
+        boost::unique_lock<boost::mutex> lock(mtx);
+        pool.back().assign(t);
+        pool.pushed();
+      }
+
+      void move_back(tendril& t)
+      {
+        boost::unique_lock<boost::mutex> lock(mtx);
+        pool.back().steal(t);
+        pool.pushed();
+      }
+
+      std::size_t size()
+      {
+        boost::unique_lock<boost::mutex> lock(mtx);
+        return pool.size();
+      }
+
+      void reserve(std::size_t n)
+      {
+        boost::unique_lock<boost::mutex> lock(mtx);
+        pool.reserve(n);
+      }
+
+      boost::mutex mtx;
+      slot_pool<Slot> pool;
+      tendril scratch;
+    };
+
+    //
+    //  Each edge has exactly one producer (the scheduler thread running
+    //  the upstream cell) and one consumer (the thread running the
+    //  downstream cell), so head_ is only written by the consumer and
+    //  tail_ only by the producer.  The slots are assigned to, not
+    //  constructed/destroyed, as values go by.
+    //
+    //  The ring is sized to the edge's capacity (see edge::bound, which
+    //  reserves it), so a bounded edge never holds more than the ring does:
+    //  its overflow policy deals with a full ring.  Only an unbounded edge
+    //  can get more than the ring's size ahead, then the producer spills to
+    //  a locked slot_pool instead of blocking, as a blocked producer may
+    //  hold the strand that the consumer needs.  Once anything has spilled,
+    //  the producer keeps spilling until the consumer has drained the
+    //  spill, so FIFO order is kept.
+    //
+    template<typename Slot>
+    struct ring_queue : queue_base
+    {
+      enum { MIN_CAPACITY = 16 }; // the ring's size is a power of two
+
+      ring_queue()
+        : head_(0)
+        , tail_(0)
+        , nspilled_(0)
+        , mask_(MIN_CAPACITY - 1)
+        , slots_(MIN_CAPACITY)
+      { }
+
+      tendril& front()
+      {
+        std::size_t h = head_;
+        if (h != load_acquire(tail_))
+          return slots_[h & mask_].front(scratch_);
+        boost::unique_lock<boost::mutex> lock(spill_mtx_);
+        return spill_.front().front(scratch_);
+      }
+
+      std::size_t front_tick()
+      {
+        std::size_t h = head_;
+        if (h != load_acquire(tail_))
+          return slots_[h & mask_].front_tick();
+        boost::unique_lock<boost::mutex> lock(spill_mtx_);
+        return spill_.front().front_tick();
+      }
+
+      void pop_front()
+      {
+        std::size_t h = head_;
+        if (h != load_acquire(tail_))
+        {
+          slots_[h & mask_].clear();
+          store_release(head_, h + 1);
+          return;
+        }
+        boost::unique_lock<boost::mutex> lock(spill_mtx_);
+        spill_.pop_front();
+        store_release(nspilled_, spill_.size());
+      }
+
+      void take_front(tendril& t)
+      {
+        std::size_t h = head_;
+        if (h != load_acquire(tail_))
+        {
+          slots_[h & mask_].give(t);
+          slots_[h & mask_].clear();
+          store_release(head_, h + 1);
+          return;
+        }
+        boost::unique_lock<boost::mutex> lock(spill_mtx_);
+        spill_.front().give(t);
+        spill_.pop_front();
+        store_release(nspilled_, spill_.size());
+      }
+
+      void push_back(const tendril& t)
+      {
+        Slot* slot = ring_slot();
+        if (slot)
+        {
+          slot->assign(t);
+          store_release(tail_, tail_ + 1);
+          return;
+        }
+        boost::unique_lock<boost::mutex> lock(spill_mtx_);
+        spill_.back().assign(t);
+        spill_.pushed();
+        store_release(nspilled_, spill_.size());
+      }
+
+      void move_back(tendril& t)
+      {
+        Slot* slot = ring_slot();
+        if (slot)
+        {
+          slot->steal(t);
+          store_release(tail_, tail_ + 1);
+          return;
+        }
+        boost::unique_lock<boost::mutex> lock(spill_mtx_);
+        spill_.back().steal(t);
+        spill_.pushed();
+        store_release(nspilled_, spill_.size());
+      }
+
+      //! the free slot at the tail, or 0 if the producer has to spill.
+      Slot* ring_slot()
+      {
+        if (load_acquire(nspilled_) != 0)
+          return 0;
+        std::size_t tl = tail_;
+        if (tl - load_acquire(head_) > mask_)
+          return 0;
+        return &slots_[tl & mask_];
+      }
+
+      std::size_t size()
+      {
+        return load_acquire(tail_) - load_acquire(head_) + load_acquire(nspilled_);
+      }
+
+      //! grow the ring to hold n values, moving in what it and the spill
+      //! hold.  Only called while the edge is idle, see edge::bound.
+      void reserve(std::size_t n)
+      {
+        boost::unique_lock<boost::mutex> lock(spill_mtx_);
+        std::size_t count = size(), ring = slots_.size();
+        while (ring < std::max(n, count))
+          ring *= 2;
+        if (ring == slots_.size() && nspilled_ == 0)
+          return;
+        std::vector<Slot> bigger(ring);
+        std::size_t k = 0;
+        for (std::size_t h = head_; h != tail_; ++h)
+          bigger[k++] = slots_[h & mask_];
+        for (; spill_.size() != 0; spill_.pop_front())
+          bigger[k++] = spill_.front();
+        slots_.swap(bigger);
+        mask_ = ring - 1;
+        head_ = 0;
+        tail_ = k;
+        nspilled_ = 0;
+      }
+
+      volatile std::size_t head_;
+      char pad0_[CACHE_LINE_SIZE - sizeof(std::size_t)];
+      volatile std::size_t tail_;
+      char pad1_[CACHE_LINE_SIZE - sizeof(std::size_t)];
+      volatile std::size_t nspilled_;
+      std::size_t mask_;
+      std::vector<Slot> slots_;
+      boost::mutex spill_mtx_;
+      slot_pool<Slot> spill_;
+      tendril scratch_;
+    };
+
+    template<typename Slot>
+    queue_base* make_queue(edge::queue_type q)
+    {
+      switch (q)
+      {
+        case edge::RINGBUFFER:
+          return new ring_queue<Slot>;
+        case edge::DEQUE:
+        default:
+          return new deque_queue<Slot>;
+      }
+    }
+  }
+}
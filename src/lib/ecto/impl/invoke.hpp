@@ -28,13 +28,74 @@
  */
 #pragma once
 
-#include <ecto/impl/graph_types.hpp>
+#include <ecto/impl/plan.hpp>
+#include <ecto/completion.hpp>
 
 namespace ecto {
   namespace schedulers {
 
-    int 
-    invoke_process(graph::graph_t& graph, graph::graph_t::vertex_descriptor vd);
+    /**
+     * \brief Hand one value of an output port to its edge.  A shared payload
+     * is frozen first, so the edge and the consumers get a handle to it.  A
+     * value the cell rewrites every tick, on the only edge its port feeds,
+     * is moved rather than copied.
+     */
+    void
+    push_output(const plan::output& out, tendril& from);
+
+    //! run one step of the plan: pull its inputs, process, push its outputs
+    int
+    invoke_process(const plan& p, std::size_t step);
+
+    /**
+     * \brief Start a tick of an async() step: pull its inputs and call its
+     * process_async.  parked is true if it was called, c's handler then
+     * calls finish_process, once c is.  Otherwise the tick was skipped or
+     * the cell asked to stop, and it is over.
+     */
+    int
+    start_process(const plan& p, std::size_t step, const completion& c, bool& parked);
+
+    //! End a parked tick that ended with rval: push the outputs, if it is OK.
+    int
+    finish_process(const plan& p, std::size_t step, int rval);
+
+    /**
+     * \brief Run n ticks of one step, in one process_batch call if the cell
+     * is batched() and each input has n values queued, else tick by tick.
+     */
+    int
+    invoke_process_batch(const plan& p, std::size_t step, std::size_t n);
+
+    /**
+     * \brief n, lowered to the capacity of the smallest bounded edge, the
+     * most ticks a producer can run ahead of its consumers without blocking
+     * or dropping values.
+     */
+    std::size_t
+    batch_limit(const plan& p, std::size_t n);
+
+    /**
+     * \brief n, lowered to the capacity of the smallest BLOCK edge.  With
+     * no more ticks than that in flight no producer ever waits for room,
+     * which it would do holding its strand, stalling a consumer on the
+     * same strand for good.  So the schedulers throttle the source rather
+     * than block its producer, see plasm::connect.
+     */
+    std::size_t
+    in_flight_limit(const plan& p, std::size_t n);
+
+    /**
+     * \brief n, lowered to the capacity of each BLOCK edge whose producer,
+     * waiting for room on it, could stall the tick its consumer needs for
+     * good: the producer holds its strand, so a cell on the same strand
+     * that the tick has yet to pass would wait on it.  Without
+     * threads_for_all, fewer threads than ticks in flight, every BLOCK edge
+     * counts, as the threads may all be waiting on the producer.  For the
+     * multithreaded scheduler, whose ticks each run the whole plan in order.
+     */
+    std::size_t
+    strand_limit(const plan& p, std::size_t n, bool threads_for_all);
 
   }
 }
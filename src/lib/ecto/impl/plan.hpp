@@ -0,0 +1,81 @@
+/*
+ * Copyright (c) 2011, Willow Garage, Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the Willow Garage, Inc. nor the names of its
+ *       contributors may be used to endorse or promote products derived from
+ *       this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#pragma once
+
+#include <ecto/forward.hpp>
+#include <ecto/impl/graph_types.hpp>
+
+#include <vector>
+
+namespace ecto {
+  namespace schedulers {
+
+    /**
+     * \brief The graph flattened for execution.
+     *
+     * The cells in topological order, each with its incoming and outgoing
+     * edges and the ports on either end resolved to raw pointers, so a tick
+     * does no string keyed lookups, takes no tendrils locks and copies no
+     * shared pointers. Built by scheduler::compute_stack after the cells are
+     * configured, it is only valid as long as the plasm isn't edited.
+     */
+    struct plan
+    {
+      struct input
+      {
+        graph::edge* edge;
+        tendril* port;
+      };
+
+      struct output
+      {
+        tendril* port;
+        graph::edge* edge;
+        bool single_consumer; //!< this edge is the only one fed by port
+      };
+
+      struct step
+      {
+        cell_ptr c;
+        graph::graph_t::vertex_descriptor vd;
+        //! [begin, end) ranges of plan::inputs and plan::outputs
+        std::size_t inputs_begin, inputs_end, outputs_begin, outputs_end;
+        //! an input of the cell, or of a cell upstream, is a lossy edge
+        bool lossy;
+      };
+
+      plan(graph::graph_t& graph, const std::vector<graph::graph_t::vertex_descriptor>& stack);
+
+      std::vector<step> steps;
+      std::vector<input> inputs;
+      std::vector<output> outputs;
+    };
+
+  }
+}
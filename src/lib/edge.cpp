@@ -26,23 +26,142 @@
 // POSSIBILITY OF SUCH DAMAGE.
 // 
 #include <ecto/all.hpp>
+#include <ecto/impl/edge_queue.hpp>
 
 #include <boost/thread.hpp>
+#include <boost/scoped_ptr.hpp>
 
 namespace ecto {
   namespace graph {
 
+    namespace {
+      //! the typed queue factory for the type with the given id, or 0.
+      type_ops::queue_fn typed_queue(std::size_t type)
+      {
+        type_ops* t = types::by_id(type);
+        return t ? load_acquire(t->make_queue) : 0;
+      }
+
+      queue_base* make_edge_queue(edge::queue_type q, std::size_t type)
+      {
+        type_ops::queue_fn f = typed_queue(type);
+        return f ? f(q) : make_queue<erased_slot>(q);
+      }
+    }
+
+    queue_base* make_typed_queue(unsigned q)
+    {
+      return make_queue<typed_slot>(edge::queue_type(q));
+    }
+
     struct edge::impl {
+      impl()
+        : capacity(0)
+        , policy(BLOCK)
+        , dropped(0)
+        , blocked(boost::posix_time::microseconds(0))
+        , waiting(0)
+      { }
+
+      //
+      //  Only the producer pushes, so once there is room it stays there
+      //  until the push.  DROP_OLDEST edges are the exception, there the
+      //  producer pops as well, so both ends go through mtx.
+      //
+      bool full()
+      {
+        return capacity != 0 && queue->size() >= capacity;
+      }
+
+      //! returns false if the value being pushed is to be discarded.
+      bool make_room()
+      {
+        if (!full())
+          return true;
+        switch (policy)
+        {
+          case DROP_NEWEST:
+          {
+            boost::unique_lock<boost::mutex> lock(mtx);
+            ++dropped;
+            return false;
+          }
+          case DROP_OLDEST: //the caller holds mtx, see locked()
+            queue->pop_front();
+            ++dropped;
+            return true;
+          case BLOCK:
+          default:
+          {
+            boost::posix_time::ptime start = boost::posix_time::microsec_clock::universal_time();
+            boost::unique_lock<boost::mutex> lock(mtx);
+            //announced before full() is checked again, see popped()
+            fetch_and_add(waiting, std::size_t(1));
+            try
+            {
+              while (full())
+                room.wait(lock); //an interruption point, so the scheduler can get us out.
+            }
+            catch (...)
+            {
+              fetch_and_add(waiting, std::size_t(-1));
+              throw;
+            }
+            fetch_and_add(waiting, std::size_t(-1));
+            blocked += boost::posix_time::microsec_clock::universal_time() - start;
+            return true;
+          }
+        }
+      }
+
+      //
+      //  The consumer only takes mtx when a producer waits for room, so a
+      //  ring edge stays lock free while it has room.  Both sides go
+      //  through a full barrier between their write and their read, the
+      //  pop before reading waiting here, waiting before full() in
+      //  make_room, so either the producer sees the room or we see it wait.
+      //
+      void popped()
+      {
+        if (capacity == 0 || policy != BLOCK)
+          return;
+        if (fetch_and_add(waiting, std::size_t(0)) == 0)
+          return;
+        {
+          boost::unique_lock<boost::mutex> lock(mtx);
+        }
+        room.notify_one();
+      }
+
+      bool locked() const
+      {
+        return capacity != 0 && policy == DROP_OLDEST;
+      }
+
       std::string from_port, to_port;
+      queue_type type;
+      std::size_t value_type;
+      boost::scoped_ptr<queue_base> queue;
+      std::size_t capacity;
+      overflow_policy policy;
+      // written by the producer, guarded by mtx as they are read from any thread
+      std::size_t dropped;
+      boost::posix_time::time_duration blocked;
+      //! producers in make_room waiting for the consumer to pop
+      volatile std::size_t waiting;
       boost::mutex mtx;
-      std::deque<ecto::tendril> deque;
+      boost::condition_variable room;
     };
 
-    edge::edge(const std::string& fp, const std::string& tp) 
+    edge::edge(const std::string& fp, const std::string& tp, queue_type q, std::size_t type)
       : impl_(new impl)
     { 
       impl_->from_port = fp;
       impl_->to_port = tp;
+      impl_->type = q;
+      //types without a registered typed queue fall back to the type erased one.
+      impl_->value_type = typed_queue(type) ? type : 0;
+      impl_->queue.reset(make_edge_queue(q, impl_->value_type));
     }
 
     const std::string& edge::from_port() {
@@ -53,28 +172,174 @@ namespace ecto {
       return impl_->to_port;
     }
 
+    edge::queue_type edge::queue() const
+    {
+      return impl_->type;
+    }
+
+    void edge::queue(queue_type q)
+    {
+      if (q == impl_->type)
+        return;
+      if (impl_->queue->size() != 0)
+        BOOST_THROW_EXCEPTION(except::EctoException()
+                              << except::diag_msg("Can't change the queue of an edge that holds values")
+                              << except::from_key(impl_->from_port)
+                              << except::to_key(impl_->to_port));
+      impl_->type = q;
+      impl_->queue.reset(make_edge_queue(q, impl_->value_type));
+      impl_->queue->reserve(impl_->capacity);
+    }
+
+    void edge::relocate()
+    {
+      if (impl_->queue->size() != 0)
+        BOOST_THROW_EXCEPTION(except::EctoException()
+                              << except::diag_msg("Can't relocate an edge that holds values")
+                              << except::from_key(impl_->from_port)
+                              << except::to_key(impl_->to_port));
+      impl_->queue.reset(make_edge_queue(impl_->type, impl_->value_type));
+      //an unbounded edge allocates its first slots here too
+      impl_->queue->reserve(std::max<std::size_t>(impl_->capacity, 1));
+    }
+
+    std::size_t edge::value_type() const
+    {
+      return impl_->value_type;
+    }
+
+    void edge::bound(std::size_t capacity, overflow_policy policy)
+    {
+      if (capacity && impl_->queue->size() > capacity)
+        BOOST_THROW_EXCEPTION(except::EctoException()
+                              << except::diag_msg("Can't bound an edge below the values it holds")
+                              << except::from_key(impl_->from_port)
+                              << except::to_key(impl_->to_port));
+      impl_->capacity = capacity;
+      impl_->policy = policy;
+      impl_->queue->reserve(capacity);
+    }
+
+    std::size_t edge::capacity() const
+    {
+      return impl_->capacity;
+    }
+
+    edge::overflow_policy edge::overflow() const
+    {
+      return impl_->policy;
+    }
+
+    bool edge::lossy() const
+    {
+      return impl_->capacity != 0 && impl_->policy != BLOCK;
+    }
+
+    std::size_t edge::dropped() const
+    {
+      boost::unique_lock<boost::mutex> lock(impl_->mtx);
+      return impl_->dropped;
+    }
+
+    boost::posix_time::time_duration edge::blocked_time() const
+    {
+      boost::unique_lock<boost::mutex> lock(impl_->mtx);
+      return impl_->blocked;
+    }
+
     tendril& edge::front() 
     { 
-      boost::unique_lock<boost::mutex> lock(impl_->mtx);
-      return impl_->deque.front();
+      return impl_->queue->front();
     }
 
     void edge::pop_front() 
     { 
-      boost::unique_lock<boost::mutex> lock(impl_->mtx);
-      impl_->deque.pop_front(); 
+      if (impl_->locked())
+      {
+        boost::unique_lock<boost::mutex> lock(impl_->mtx);
+        impl_->queue->pop_front();
+        return;
+      }
+      impl_->queue->pop_front();
+      impl_->popped();
     }
+
+    void edge::take_front(ecto::tendril& t)
+    {
+      if (impl_->locked())
+      {
+        boost::unique_lock<boost::mutex> lock(impl_->mtx);
+        impl_->queue->take_front(t);
+        return;
+      }
+      impl_->queue->take_front(t);
+      impl_->popped();
+    }
+
+    bool edge::front_tick(std::size_t& tick)
+    {
+      boost::unique_lock<boost::mutex> lock(impl_->mtx, boost::defer_lock);
+      if (impl_->locked())
+        lock.lock();
+      if (impl_->queue->size() == 0)
+        return false;
+      tick = impl_->queue->front_tick();
+      return true;
+    }
+
+    bool edge::take_tick(std::size_t tick, ecto::tendril& t)
+    {
+      bool taken = false, popped = false;
+      {
+        boost::unique_lock<boost::mutex> lock(impl_->mtx, boost::defer_lock);
+        if (impl_->locked())
+          lock.lock();
+        while (impl_->queue->size() != 0 && impl_->queue->front_tick() < tick)
+        {
+          impl_->queue->pop_front();
+          popped = true;
+        }
+        if (impl_->queue->size() != 0 && impl_->queue->front_tick() == tick)
+        {
+          impl_->queue->take_front(t);
+          taken = popped = true;
+        }
+      }
+      if (popped && !impl_->locked())
+        impl_->popped();
+      return taken;
+    }
+
     void edge::push_back(const ecto::tendril& t) 
     {
-      boost::unique_lock<boost::mutex> lock(impl_->mtx);
-      impl_->deque.push_back(t);
+      if (impl_->locked())
+      {
+        boost::unique_lock<boost::mutex> lock(impl_->mtx);
+        impl_->make_room();
+        impl_->queue->push_back(t);
+        return;
+      }
+      if (impl_->make_room())
+        impl_->queue->push_back(t);
+    }
+
+    void edge::move_back(ecto::tendril& t)
+    {
+      if (impl_->locked())
+      {
+        boost::unique_lock<boost::mutex> lock(impl_->mtx);
+        impl_->make_room();
+        impl_->queue->move_back(t);
+        return;
+      }
+      if (impl_->make_room())
+        impl_->queue->move_back(t);
     }
+
     std::size_t edge::size() 
     {
-      boost::unique_lock<boost::mutex> lock(impl_->mtx);
-      return impl_->deque.size(); 
+      return impl_->queue->size();
     }
 
   }
 }
-
@@ -210,6 +210,13 @@ namespace ecto
     impl_->connect(from, output, to, input);
   }
 
+  void
+  plasm::connect(cell_ptr from, const std::string& output, cell_ptr to, const std::string& input,
+                 std::size_t capacity, graph::edge::overflow_policy policy)
+  {
+    impl_->connect(from, output, to, input, capacity, policy);
+  }
+
   void
   plasm::viz(std::ostream& out) const
   {
@@ -230,6 +237,37 @@ namespace ecto
     impl_->disconnect(from, output, to, input);
   }
 
+  graph::edge::queue_type
+  plasm::edge_queue() const
+  {
+    return impl_->edge_queue;
+  }
+
+  void
+  plasm::edge_queue(graph::edge::queue_type q)
+  {
+    graph_t::edge_iterator beg, end;
+    tie(beg, end) = edges(impl_->graph);
+    while (beg != end)
+    {
+      impl_->graph[*beg]->queue(q);
+      ++beg;
+    }
+    impl_->edge_queue = q;
+  }
+
+  boost::posix_time::time_duration
+  plasm::deadline() const
+  {
+    return impl_->deadline;
+  }
+
+  void
+  plasm::deadline(const boost::posix_time::time_duration& d)
+  {
+    impl_->deadline = d;
+  }
+
   graph::graph_t&
   plasm::graph()
   {
@@ -261,6 +299,34 @@ namespace ecto
     };
   }
 
+  std::size_t
+  plasm::flatten()
+  {
+    std::size_t n = 0;
+    for (;;)
+    {
+      cell_ptr box;
+      plasm_ptr inner;
+      BOOST_FOREACH(impl::ModuleVertexMap::value_type& x, impl_->mv_map)
+          {
+            inner = x.first->subgraph();
+            if (inner)
+            {
+              box = x.first;
+              break;
+            }
+          }
+      if (!box)
+        return n;
+      if (inner.get() == this)
+        BOOST_THROW_EXCEPTION(except::EctoException()
+                              << except::diag_msg("a cell's subgraph is the plasm it is in")
+                              << except::cell_name(box->name()));
+      impl_->splice(box, *inner);
+      ++n;
+    }
+  }
+
   std::vector<cell_ptr>
   plasm::cells() const
   {
@@ -42,15 +42,19 @@ namespace ecto {
     using boost::add_vertex;
 
     graph::edge_ptr
-    make_edge(const std::string& fromport, const std::string& toport)
+    make_edge(const std::string& fromport, const std::string& toport, edge::queue_type q,
+              std::size_t type)
     {
-      graph::edge_ptr eptr(new graph::edge(fromport, toport));
+      graph::edge_ptr eptr(new graph::edge(fromport, toport, q, type));
       return eptr;
     }
   } // namespace
 
 
-  plasm::impl::impl() {}
+  plasm::impl::impl()
+    : edge_queue(edge::DEQUE)
+    , deadline(boost::posix_time::seconds(0))
+  { }
 
     //insert a cell into the graph, will retrieve the
     //vertex descriptor if its already in the graph...
@@ -67,7 +71,8 @@ namespace ecto {
   }
 
   void
-  plasm::impl::connect(cell_ptr from, std::string output, cell_ptr to, std::string input)
+  plasm::impl::connect(cell_ptr from, std::string output, cell_ptr to, std::string input,
+                       std::size_t capacity, edge::overflow_policy policy)
   {
     //connect does all sorts of type checking so that connections are always valid.
     tendril_ptr from_port, to_port;
@@ -107,7 +112,14 @@ namespace ecto {
       }
 
     graph_t::vertex_descriptor fromv = insert_module(from), tov = insert_module(to);
-    graph::edge_ptr new_edge = make_edge(output, input);
+    //same concrete type on both ends, the edge can store the value directly and
+    //skip the per tick type checks. Frozen values go by as their payload handle.
+    std::size_t type = 0;
+    if (from_port->same_type(*to_port) && !from_port->is_type<tendril::none>()
+        && !from_port->is_type<boost::python::object>())
+      type = from_port->type_id();
+    graph::edge_ptr new_edge = make_edge(output, input, edge_queue, type);
+    new_edge->bound(capacity, policy);
 
     //assert that the new edge does not violate inputs that are already connected.
     //RULE an input may only have one source.
@@ -147,5 +159,113 @@ namespace ecto {
     boost::remove_edge(fromv, tov, graph);
   }
 
+  void
+  plasm::impl::remove_module(cell_ptr m)
+  {
+    ModuleVertexMap::iterator it = mv_map.find(m);
+    if (it == mv_map.end())
+      return;
+    boost::clear_vertex(it->second, graph);
+    boost::remove_vertex(it->second, graph);
+    //the vertices after it moved down one
+    mv_map.clear();
+    for (std::size_t d = 0; d < boost::num_vertices(graph); ++d)
+      mv_map.insert(std::make_pair(graph[d], d));
+  }
+
+  namespace
+  {
+    //an edge of a box, moved to the cell of its subgraph the port belongs to
+    struct rewire
+    {
+      cell_ptr from, to;
+      std::string output, input;
+      graph::edge_ptr e;
+    };
+
+    //the keys of the cell's tendrils in ts that a box exports as t
+    std::vector<std::string> find_aliases(const tendrils& ts, const tendril_ptr& t)
+    {
+      std::vector<std::string> keys;
+      for (tendrils::const_iterator it = ts.begin(); it != ts.end(); ++it)
+        if (it->second == t)
+          keys.push_back(it->first);
+      return keys;
+    }
+  }
+
+  void
+  plasm::impl::splice(cell_ptr box, const plasm& inner)
+  {
+    graph_t::vertex_descriptor bv = insert_module(box);
+    //where the box's edges go once it is gone
+    std::vector<rewire> moves;
+
+    graph_t::in_edge_iterator ib, ie;
+    for (tie(ib, ie) = boost::in_edges(bv, graph); ib != ie; ++ib)
+      {
+        rewire r = { graph[boost::source(*ib, graph)], cell_ptr(), graph[*ib]->from_port(), "",
+                     graph[*ib] };
+        tendril_ptr t = box->inputs[r.e->to_port()];
+        const graph_t& g = inner.graph();
+        //an exported input may be declared on several cells, each gets the edge
+        std::size_t found = moves.size();
+        for (std::size_t d = 0; d < boost::num_vertices(g); ++d)
+          {
+            std::vector<std::string> keys = find_aliases(g[d]->inputs, t);
+            for (std::size_t k = 0; k < keys.size(); ++k)
+              {
+                r.to = g[d];
+                r.input = keys[k];
+                moves.push_back(r);
+              }
+          }
+        if (moves.size() == found)
+          BOOST_THROW_EXCEPTION(EctoException()
+                                << diag_msg("no cell of the subgraph has the exported input")
+                                << cell_name(box->name())
+                                << tendril_key(r.e->to_port()));
+      }
+    graph_t::out_edge_iterator ob, oe;
+    for (tie(ob, oe) = boost::out_edges(bv, graph); ob != oe; ++ob)
+      {
+        rewire r = { cell_ptr(), graph[boost::target(*ob, graph)], "", graph[*ob]->to_port(),
+                     graph[*ob] };
+        tendril_ptr t = box->outputs[r.e->from_port()];
+        const graph_t& g = inner.graph();
+        for (std::size_t d = 0; d < boost::num_vertices(g) && !r.from; ++d)
+          {
+            std::vector<std::string> keys = find_aliases(g[d]->outputs, t);
+            if (!keys.empty())
+              {
+                r.from = g[d];
+                r.output = keys.front();
+              }
+          }
+        if (!r.from)
+          BOOST_THROW_EXCEPTION(EctoException()
+                                << diag_msg("no cell of the subgraph has the exported output")
+                                << cell_name(box->name())
+                                << tendril_key(r.e->from_port()));
+        moves.push_back(r);
+      }
+
+    remove_module(box);
+
+    const graph_t& g = inner.graph();
+    for (std::size_t d = 0; d < boost::num_vertices(g); ++d)
+      insert_module(g[d]);
+    graph_t::edge_iterator eb, ee;
+    for (tie(eb, ee) = boost::edges(g); eb != ee; ++eb)
+      {
+        graph::edge_ptr e = g[*eb];
+        connect(g[boost::source(*eb, g)], e->from_port(), g[boost::target(*eb, g)], e->to_port(),
+                e->capacity(), e->overflow());
+      }
+    for (std::size_t j = 0; j < moves.size(); ++j)
+      connect(moves[j].from, moves[j].output, moves[j].to, moves[j].input,
+              moves[j].e->capacity(), moves[j].e->overflow());
+  }
+
 }
 
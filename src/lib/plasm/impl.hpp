@@ -43,15 +43,24 @@ namespace ecto {
     //vertex descriptor if its already in the graph...
     graph::graph_t::vertex_descriptor insert_module(cell_ptr m);
 
-    void connect(cell_ptr from, std::string output, cell_ptr to, std::string input);
+    void connect(cell_ptr from, std::string output, cell_ptr to, std::string input,
+                 std::size_t capacity = 0, graph::edge::overflow_policy policy = graph::edge::BLOCK);
 
     void disconnect(cell_ptr from, std::string output, cell_ptr to, std::string input);
 
+    //take a cell and its edges out of the graph
+    void remove_module(cell_ptr m);
+
+    //replace box by the cells and edges of inner, see plasm::flatten
+    void splice(cell_ptr box, const plasm& inner);
+
     //the cell to vertex mapping
     //unordered_map so that cell ptr works as a key...
     typedef boost::unordered_map<cell_ptr, graph::graph_t::vertex_descriptor> ModuleVertexMap;
     ModuleVertexMap mv_map;
     graph::graph_t graph;
+    graph::edge::queue_type edge_queue;
+    boost::posix_time::time_duration deadline;
 
   };
 }
@@ -132,10 +132,13 @@ namespace ecto {
 
     graph_stats_type::graph_stats_type()
       : start_tick(0), stop_tick(0), cumulative_ticks(0)
+      , deadline_ticks(0), deadline_misses(0), deadline_splits(0)
     { }
 
     void graph_stats_type::start()
     {
+      deadline_ticks = deadline_misses = deadline_splits = 0;
+      worst_lateness = pt::microseconds(0);
       start_time = pt::microsec_clock::universal_time();
       start_tick = profile::read_tsc();
     }
@@ -175,6 +178,36 @@ namespace ecto {
               << "\n";
           }
 
+      bool bounded = false;
+      graph::graph_t::edge_iterator ebegin, eend;
+      for (tie(ebegin, eend) = edges(g); ebegin != eend; ++ebegin)
+        {
+          graph::edge_ptr e = g[*ebegin];
+          if (e->capacity() == 0)
+            continue;
+          if (!bounded)
+            oss << hline
+                << str(boost::format("* %-40s %-8s %-8s %-10s\n") % "Bounded edge" % "Capacity" % "Dropped" % "Blocked (s)");
+          bounded = true;
+          std::string name = g[source(*ebegin, g)]->name() + "." + e->from_port()
+            + " -> " + g[target(*ebegin, g)]->name() + "." + e->to_port();
+          oss << str(boost::format("* %-40s %-8u %-8u %-10.3f")
+                     % name
+                     % e->capacity()
+                     % e->dropped()
+                     % (e->blocked_time().total_microseconds() / 1e+06))
+              << "\n";
+        }
+
+      if (deadline_ticks)
+        oss << hline
+            << str(boost::format("* deadline missed by %u of %u ticks, worst by %.6f s\n")
+                   % deadline_misses
+                   % deadline_ticks
+                   % (worst_lateness.total_microseconds() / 1e+06));
+      if (deadline_splits)
+        oss << str(boost::format("* %u ticks gave their cells different deadlines\n")
+                   % deadline_splits);
 
       oss << hline
           << "cpu ticks:        " << cumulative_ticks
@@ -27,6 +27,8 @@
 //
 
 #include <ecto/log.hpp>
+#include <ecto/affinity.hpp>
+#include <ecto/edge.hpp>
 
 #include <ecto/cell.hpp>
 #include <ecto/scheduler.hpp>
@@ -58,12 +60,32 @@ namespace ecto {
       SINGLE_THREADED_SIGINT_SIGNAL();
       PyErr_SetInterrupt();
     }
+
+    //! the cpus of `from' on node, all of from if there are none
+    std::vector<unsigned> on_node(const std::vector<unsigned>& from, int node)
+    {
+      std::vector<unsigned> c;
+      for (std::size_t j = 0; j < from.size(); ++j)
+        if (affinity::node_of(from[j]) == node)
+          c.push_back(from[j]);
+      return c.empty() ? from : c;
+    }
+
+    void relocate_from(int cpu, const std::vector<graph::edge_ptr>& edges)
+    {
+      if (cpu >= 0)
+        affinity::pin(cpu);
+      for (std::size_t j = 0; j < edges.size(); ++j)
+        edges[j]->relocate();
+    }
   }
 
   scheduler::scheduler(plasm_ptr p)
     : plasm(p)
     , graph(p->graph())
     , running_value(false)
+    , batch_(1)
+    , placed_(true)
   {
     // for good measure
     PyEval_InitThreads();
@@ -123,7 +145,12 @@ namespace ecto {
       interupt_connection(SINGLE_THREADED_SIGINT_SIGNAL.connect(boost::bind(&scheduler::interrupt, this)));
 
     compute_stack();
+    place_buffers();
     notify_start();
+    {
+      mutex::scoped_lock placement_lock(placement_mtx_);
+      placement_.clear();
+    }
 
     //so that python may resume, means that all threads that would like
     //to use python must create a scoped_call_back_to_python object
@@ -132,7 +159,7 @@ namespace ecto {
     running(true);
 
     if (nthread == 0)
-      nthread = boost::thread::hardware_concurrency();
+      nthread = cpus_.empty() ? boost::thread::hardware_concurrency() : unsigned(cpus_.size());
 
     int rv;
     {
@@ -178,12 +205,17 @@ namespace ecto {
 
     //these should happen in the calling thread
     compute_stack();
+    place_buffers();
     notify_start();
+    {
+      mutex::scoped_lock placement_lock(placement_mtx_);
+      placement_.clear();
+    }
 
     running(true);
 
     if (nthread == 0)
-      nthread = boost::thread::hardware_concurrency();
+      nthread = cpus_.empty() ? boost::thread::hardware_concurrency() : unsigned(cpus_.size());
 
     exec e(*this, niter, nthread);
 
@@ -201,15 +233,116 @@ namespace ecto {
     plasm->configure_all();
     boost::topological_sort(graph, std::back_inserter(stack));
     std::reverse(stack.begin(), stack.end());
+    plan.reset(new schedulers::plan(graph, stack));
+    try {
+      compute_stack_impl();
+    } catch (...) {
+      //so that the next execute tries again.
+      stack.clear();
+      plan.reset();
+      throw;
+    }
+  }
+
+  void scheduler::cpus(const std::vector<unsigned>& c)
+  {
+    cpus_ = c;
+  }
+
+  std::vector<unsigned> scheduler::cpus() const
+  {
+    return cpus_;
+  }
+
+  void scheduler::one_per_core()
+  {
+    cpus_ = affinity::physical_cores();
+  }
+
+  void scheduler::numa_node(const cell_ptr& c, int node)
+  {
+    if (node < 0)
+      nodes_.erase(c);
+    else
+      nodes_[c] = node;
+    placed_ = false;
+  }
+
+  int scheduler::numa_node(const cell_ptr& c) const
+  {
+    std::map<cell_ptr, int>::const_iterator it = nodes_.find(c);
+    return it == nodes_.end() ? -1 : it->second;
+  }
+
+  std::vector<int> scheduler::placement() const
+  {
+    mutex::scoped_lock lock(placement_mtx_);
+    return placement_;
+  }
+
+  int scheduler::worker_cpu(unsigned j, int node)
+  {
+    std::vector<unsigned> from = cpus_;
+    if (node >= 0)
+      from = on_node(from.empty() ? affinity::cpus() : from, node);
+    int cpu = from.empty() ? -1 : int(from[j % from.size()]);
+    mutex::scoped_lock lock(placement_mtx_);
+    if (placement_.size() <= j)
+      placement_.resize(j + 1, -1);
+    placement_[j] = cpu;
+    return cpu;
+  }
+
+  //
+  //  Memory is placed on the node of the thread that first touches it, so
+  //  the queues of the edges of bound cells are allocated again from a
+  //  thread pinned to their node.  An edge between cells on different nodes
+  //  goes with its consumer.  Edges still holding values are left alone.
+  //
+  void scheduler::place_buffers()
+  {
+    if (placed_)
+      return;
+    std::map<int, std::vector<graph::edge_ptr> > by_node;
+    graph_t::edge_iterator b, e;
+    for (boost::tie(b, e) = boost::edges(graph); b != e; ++b)
+      {
+        int node = numa_node(graph[boost::target(*b, graph)]);
+        if (node < 0)
+          node = numa_node(graph[boost::source(*b, graph)]);
+        if (node >= 0 && graph[*b]->size() == 0)
+          by_node[node].push_back(graph[*b]);
+      }
+    for (std::map<int, std::vector<graph::edge_ptr> >::const_iterator it = by_node.begin();
+         it != by_node.end(); ++it)
+      {
+        std::vector<unsigned> from = on_node(cpus_.empty() ? affinity::cpus() : cpus_, it->first);
+        thread t(boost::bind(&relocate_from, from.empty() ? -1 : int(from[0]),
+                             boost::cref(it->second)));
+        t.join();
+      }
+    placed_ = true;
+  }
+
+  void scheduler::batch(unsigned n)
+  {
+    batch_ = std::max(n, 1u);
+  }
+
+  unsigned scheduler::batch() const
+  {
+    return batch_;
   }
 
-  int scheduler::invoke_process(graph_t::vertex_descriptor vd)
+  int scheduler::invoke_process(std::size_t step, std::size_t n)
   {
     ECTO_START();
 
     int rv;
     try {
-      rv = ecto::schedulers::invoke_process(graph, vd);
+      rv = n > 1
+        ? ecto::schedulers::invoke_process_batch(*plan, step, n)
+        : ecto::schedulers::invoke_process(*plan, step);
     } catch (const boost::thread_interrupted& e) {
       std::cout << "Interrupted\n";
       return ecto::QUIT;
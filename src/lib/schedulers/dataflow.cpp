@@ -0,0 +1,796 @@
+//
+// Copyright (c) 2011, Willow Garage, Inc.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//     * Neither the name of the Willow Garage, Inc. nor the names of its
+//       contributors may be used to endorse or promote products derived from
+//       this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+#include <ecto/log.hpp>
+#include <ecto/cell.hpp>
+#include <ecto/edge.hpp>
+#include <ecto/atomic.hpp>
+#include <ecto/affinity.hpp>
+#include <ecto/completion.hpp>
+#include <ecto/thread_pool.hpp>
+
+#include <ecto/impl/graph_types.hpp>
+#include <ecto/impl/invoke.hpp>
+#include <ecto/impl/plan.hpp>
+#include <ecto/impl/schedulers/access.hpp>
+#include <ecto/schedulers/dataflow.hpp>
+
+#include <boost/bind.hpp>
+#include <boost/cstdint.hpp>
+#include <boost/date_time/posix_time/posix_time_types.hpp>
+#include <boost/exception_ptr.hpp>
+#include <boost/noncopyable.hpp>
+#include <boost/scoped_ptr.hpp>
+#include <boost/thread.hpp>
+#include <boost/unordered_map.hpp>
+
+#include <algorithm>
+#include <deque>
+#include <map>
+#include <vector>
+
+namespace ecto {
+
+  namespace schedulers {
+
+    using namespace ecto::graph;
+
+    namespace {
+
+      //! one tick of one cell
+      struct task
+      {
+        std::size_t step, tick;
+        int priority;
+        //! microseconds into the run, 0 without a deadline
+        boost::int64_t deadline;
+      };
+
+      //! heap order, the most urgent task on top
+      struct less_urgent
+      {
+        bool operator()(const task& a, const task& b) const
+        {
+          if (a.priority != b.priority)
+            return a.priority < b.priority;
+          if (a.deadline != b.deadline)
+            return a.deadline > b.deadline;
+          return a.tick > b.tick;
+        }
+      };
+
+      //! where the tasks of cells that share a strand wait while one of them runs
+      struct strand_queue : boost::noncopyable
+      {
+        strand_queue() : busy(false) { }
+        boost::mutex mtx;
+        bool busy;
+        std::deque<task> waiting;
+      };
+
+      //! a worker's tasks, the owner works at the back, thieves take from the
+      //! front.  Kept as a heap instead when the state is ordered.
+      struct task_deque : boost::noncopyable
+      {
+        boost::mutex mtx;
+        std::deque<task> tasks;
+      };
+
+      struct node
+      {
+        //! distinct producers and consumers, as step indices
+        std::vector<std::size_t> preds, succs;
+        strand_queue* strand;
+        //! the worker its ticks are pushed to, -1 for whichever readied it
+        int home;
+        int priority;
+        //! its ticks are parked until their completion is called
+        bool async;
+        //! ticks finished, written only by the worker that ran the last one
+        volatile std::size_t done;
+        //! ticks handed to workers, advanced with compare_and_swap
+        volatile std::size_t claimed;
+        //! the deadlines its ticks were given, by tick modulo their size
+        std::vector<boost::int64_t> deadlines;
+      };
+
+      inline std::size_t decrement(volatile std::size_t& v)
+      {
+        return fetch_and_add(v, std::size_t(-1)) - 1;
+      }
+    }
+
+    //
+    //  Ready tasks are taken most urgent first when any cell has a priority
+    //  or the plasm has a deadline: higher priority cells first, then the
+    //  earliest deadline, then the oldest tick.  A tick's deadline is the
+    //  time the first source claims it plus the plasm's deadline; the sink
+    //  that finishes a tick last checks it against that.  Release times sit
+    //  in a ring of window + 1 slots, a tick's slot is only reused once the
+    //  tick is through.  The slot's stamp is published after its time, the
+    //  other sources of the tick wait on it rather than read the time of the
+    //  tick that had the slot before.
+    //
+    //  A cell's tick t is ready when the cell has finished t-1 and each of
+    //  its producers has finished t.  Source cells may also run at most
+    //  `window' ticks ahead of the slowest sink; every other cell is held
+    //  back by its producers.  Whoever changes one of these conditions
+    //  (finishing a tick) rechecks the cells that depend on it, and the
+    //  claim on a tick is a compare_and_swap, so each tick is queued once.
+    //
+    struct dataflow::state : boost::noncopyable
+    {
+      state(graph_t& graph, const schedulers::plan& p_, unsigned niter_,
+            unsigned window_, unsigned nworkers, const std::vector<int>& homes,
+            const boost::posix_time::time_duration& deadline_,
+            boost::asio::io_service& serv_)
+        : p(p_)
+        , serv(serv_)
+        , async(false)
+        , pump(false)
+        , niter(niter_)
+        , window(std::max(window_, 1u))
+        , deadline(deadline_.total_microseconds())
+        , ordered(deadline > 0)
+        , start(boost::posix_time::microsec_clock::universal_time())
+        , released(0)
+        , deadline_ticks(0)
+        , deadline_misses(0)
+        , deadline_splits(0)
+        , worst_lateness(0)
+        , stopping(0)
+        , retval(ecto::OK)
+        , in_flight(0)
+        , queued(0)
+        , sleepers(0)
+        , live(nworkers)
+      {
+        std::vector<std::size_t> index(boost::num_vertices(graph));
+        for (std::size_t i = 0; i < p.steps.size(); ++i)
+          index[p.steps[i].vd] = i;
+
+        boost::unordered_map<std::size_t, boost::shared_ptr<strand_queue> > by_id;
+        nodes.resize(p.steps.size());
+        for (std::size_t i = 0; i < p.steps.size(); ++i)
+          {
+            node& n = nodes[i];
+            n.done = n.claimed = 0;
+            n.strand = 0;
+            n.home = homes[i];
+            n.priority = p.steps[i].c->priority();
+            n.async = p.steps[i].c->async();
+            if (n.async)
+              async = true;
+            if (n.priority)
+              ordered = true;
+            const cell& c = *p.steps[i].c;
+            if (c.strand_)
+              {
+                boost::shared_ptr<strand_queue>& q = by_id[c.strand_->id()];
+                if (!q)
+                  {
+                    q.reset(new strand_queue);
+                    strands.push_back(q);
+                  }
+                n.strand = q.get();
+              }
+            graph_t::in_edge_iterator b, e;
+            for (boost::tie(b, e) = boost::in_edges(p.steps[i].vd, graph); b != e; ++b)
+              {
+                std::size_t from = index[boost::source(*b, graph)];
+                if (std::find(n.preds.begin(), n.preds.end(), from) == n.preds.end())
+                  {
+                    n.preds.push_back(from);
+                    nodes[from].succs.push_back(i);
+                  }
+                //a producer that can't be more than capacity ticks ahead never blocks.
+                const graph::edge& ed = *graph[*b];
+                if (ed.capacity() && ed.overflow() == graph::edge::BLOCK)
+                  window = std::min<std::size_t>(window, ed.capacity());
+              }
+          }
+        for (std::size_t i = 0; i < nodes.size(); ++i)
+          {
+            if (nodes[i].preds.empty())
+              sources.push_back(i);
+            if (nodes[i].succs.empty())
+              sinks.push_back(i);
+          }
+        for (unsigned j = 0; j < nworkers; ++j)
+          deques.push_back(boost::shared_ptr<task_deque>(new task_deque));
+        release.resize(window + 1, 0);
+        stamp.resize(window + 1, 0);
+        remaining.resize(window + 1, 0);
+        for (std::size_t i = 0; i < nodes.size(); ++i)
+          nodes[i].deadlines.resize(window + 1, 0);
+      }
+
+      //! microseconds since the run started
+      boost::int64_t now() const
+      {
+        return (boost::posix_time::microsec_clock::universal_time() - start).total_microseconds();
+      }
+
+      //! called by each source claiming tick t, the first one starts its
+      //! clock, all of them get the time it was started
+      boost::int64_t release_tick(std::size_t t)
+      {
+        std::size_t k = t % release.size();
+        if (compare_and_swap(released, t, t + 1) == t)
+          {
+            store_release(remaining[k], sinks.size());
+            store_release(release[k], now());
+            store_release(stamp[k], t + 1);
+          }
+        else
+          while (load_acquire(stamp[k]) != t + 1)
+            boost::this_thread::yield();
+        return load_acquire(release[k]);
+      }
+
+      //! called by each sink finishing tick t, the last one checks the deadline
+      void finish_tick(std::size_t t)
+      {
+        std::size_t k = t % release.size();
+        if (decrement(remaining[k]) != 0)
+          return;
+        boost::int64_t due = load_acquire(release[k]) + deadline;
+        boost::int64_t late = now() - due;
+        bool split = false;
+        for (std::size_t i = 0; i < nodes.size(); ++i)
+          split = split || nodes[i].deadlines[k] != due;
+        boost::mutex::scoped_lock lock(deadline_mtx);
+        ++deadline_ticks;
+        if (split)
+          ++deadline_splits;
+        if (late > 0)
+          {
+            ++deadline_misses;
+            worst_lateness = std::max(worst_lateness, late);
+          }
+      }
+
+      //! ticks finished by every cell
+      std::size_t horizon() const
+      {
+        std::size_t h = std::size_t(-1);
+        for (std::size_t j = 0; j < sinks.size(); ++j)
+          h = std::min(h, load_acquire(nodes[sinks[j]].done));
+        return h;
+      }
+
+      void try_schedule(std::size_t i, unsigned w)
+      {
+        node& n = nodes[i];
+        std::size_t t = load_acquire(n.claimed);
+        if (load_acquire(n.done) != t || load_acquire(stopping))
+          return;
+        if (niter && t >= niter)
+          return;
+        for (std::size_t j = 0; j < n.preds.size(); ++j)
+          if (load_acquire(nodes[n.preds[j]].done) <= t)
+            return;
+        if (n.preds.empty() && t >= horizon() + window)
+          return;
+        if (compare_and_swap(n.claimed, t, t + 1) != t)
+          return;
+        fetch_and_add(in_flight, std::size_t(1));
+        task tk = { i, t, n.priority, 0 };
+        if (deadline)
+          {
+            std::size_t k = t % release.size();
+            tk.deadline = (n.preds.empty() ? release_tick(t) : load_acquire(release[k])) + deadline;
+            n.deadlines[k] = tk.deadline;
+          }
+        push(n.home < 0 ? w : unsigned(n.home), tk);
+      }
+
+      void push(unsigned w, const task& t)
+      {
+        {
+          boost::mutex::scoped_lock lock(deques[w]->mtx);
+          deques[w]->tasks.push_back(t);
+          if (ordered)
+            std::push_heap(deques[w]->tasks.begin(), deques[w]->tasks.end(), less_urgent());
+        }
+        fetch_and_add(queued, std::size_t(1));
+        if (load_acquire(sleepers))
+          {
+            boost::mutex::scoped_lock lock(idle_mtx);
+            idle.notify_one();
+          }
+      }
+
+      bool pop(unsigned w, task& t)
+      {
+        {
+          task_deque& d = *deques[w];
+          boost::mutex::scoped_lock lock(d.mtx);
+          if (!d.tasks.empty())
+            {
+              if (ordered)
+                std::pop_heap(d.tasks.begin(), d.tasks.end(), less_urgent());
+              t = d.tasks.back();
+              d.tasks.pop_back();
+              decrement(queued);
+              return true;
+            }
+        }
+        for (std::size_t k = 1; k < deques.size(); ++k)
+          {
+            task_deque& d = *deques[(w + k) % deques.size()];
+            boost::mutex::scoped_lock lock(d.mtx);
+            if (d.tasks.empty())
+              continue;
+            if (ordered)
+              {
+                std::pop_heap(d.tasks.begin(), d.tasks.end(), less_urgent());
+                t = d.tasks.back();
+                d.tasks.pop_back();
+              }
+            else
+              {
+                t = d.tasks.front();
+                d.tasks.pop_front();
+              }
+            decrement(queued);
+            return true;
+          }
+        return false;
+      }
+
+      void run(unsigned w, task t)
+      {
+        strand_queue* s = nodes[t.step].strand;
+        if (!s)
+          {
+            execute(w, t);
+            return;
+          }
+        {
+          boost::mutex::scoped_lock lock(s->mtx);
+          if (s->busy)
+            {
+              s->waiting.push_back(t);
+              return;
+            }
+          s->busy = true;
+        }
+        for (;;)
+          {
+            if (!execute(w, t))
+              return; //parked, the strand stays busy until resume
+            boost::mutex::scoped_lock lock(s->mtx);
+            if (s->waiting.empty())
+              {
+                s->busy = false;
+                return;
+              }
+            t = s->waiting.front();
+            s->waiting.pop_front();
+          }
+      }
+
+      //! process the tick and schedule what it readied, never throws.  False
+      //! if the tick was parked, resume then finishes it.
+      bool execute(unsigned w, const task& t)
+      {
+        node& n = nodes[t.step];
+        if (!load_acquire(stopping))
+          {
+            cell& m = *p.steps[t.step].c;
+            access cellaccess(m);
+            try
+              {
+                boost::mutex::scoped_lock lock(cellaccess.mtx);
+                int rv;
+                if (n.async)
+                  {
+                    bool parked;
+                    completion c(serv, boost::bind(&state::complete, this, w, t, _1, _2));
+                    rv = schedulers::start_process(p, t.step, c, parked);
+                    if (parked)
+                      return false;
+                  }
+                else
+                  rv = schedulers::invoke_process(p, t.step);
+                if (rv != ecto::OK)
+                  {
+                    cellaccess.stop_requested = true;
+                    stop(rv);
+                  }
+              }
+            catch (const boost::thread_interrupted&)
+              {
+                stop(ecto::QUIT);
+              }
+            catch (...)
+              {
+                fail(boost::current_exception());
+              }
+          }
+        finish(w, t);
+        return true;
+      }
+
+      //
+      //  While a tick is parked its cell's lock is free, the mutex can't be
+      //  handed to the thread that resumes the tick, but nothing else
+      //  touches the cell: the node's next tick waits for finish(), and its
+      //  strand stays busy, so the cells sharing it wait too.  resume takes
+      //  the lock again to push the outputs, then frees the strand.
+      //
+
+      //! what a completion calls.  Resuming is posted, as the completion may
+      //! be called inside process_async, where the cell's lock is still held.
+      void complete(unsigned w, const task& t, int rv, const boost::exception_ptr& e)
+      {
+        serv.post(boost::bind(&state::resume, this, w, t, rv, e));
+      }
+
+      //! the end of a parked tick, run by serv
+      void resume(unsigned w, const task& t, int rv, const boost::exception_ptr& e)
+      {
+        cell& m = *p.steps[t.step].c;
+        access cellaccess(m);
+        try
+          {
+            if (e)
+              boost::rethrow_exception(e);
+            {
+              boost::mutex::scoped_lock lock(cellaccess.mtx);
+              rv = schedulers::finish_process(p, t.step, rv);
+            }
+            if (rv != ecto::OK)
+              {
+                m.stop_requested(true);
+                stop(rv);
+              }
+          }
+        catch (...)
+          {
+            m.stop_requested(true);
+            fail(boost::current_exception());
+          }
+        finish(w, t);
+        if (strand_queue* s = nodes[t.step].strand)
+          unpark(w, *s);
+      }
+
+      //! free a strand held across a parked tick, its waiting tasks are queued again
+      void unpark(unsigned w, strand_queue& s)
+      {
+        std::deque<task> waiting;
+        {
+          boost::mutex::scoped_lock lock(s.mtx);
+          s.busy = false;
+          waiting.swap(s.waiting);
+        }
+        for (std::size_t j = 0; j < waiting.size(); ++j)
+          {
+            int home = nodes[waiting[j].step].home;
+            push(home < 0 ? w : unsigned(home), waiting[j]);
+          }
+      }
+
+      //! mark the tick done and schedule what it readied
+      void finish(unsigned w, const task& t)
+      {
+        node& n = nodes[t.step];
+        compare_and_swap(n.done, t.tick, t.tick + 1);
+        if (deadline && n.succs.empty() && !load_acquire(stopping))
+          finish_tick(t.tick);
+        try_schedule(t.step, w);
+        for (std::size_t j = 0; j < n.succs.size(); ++j)
+          try_schedule(n.succs[j], w);
+        if (n.succs.empty())
+          for (std::size_t j = 0; j < sources.size(); ++j)
+            try_schedule(sources[j], w);
+        if (decrement(in_flight) == 0)
+          {
+            boost::mutex::scoped_lock lock(idle_mtx);
+            idle.notify_all();
+          }
+      }
+
+      void stop(int rv)
+      {
+        if (compare_and_swap(stopping, 0, 1) == 0)
+          retval = rv;
+        boost::mutex::scoped_lock lock(idle_mtx);
+        idle.notify_all();
+      }
+
+      void fail(boost::exception_ptr e)
+      {
+        {
+          boost::mutex::scoped_lock lock(error_mtx);
+          if (!error)
+            error = e;
+        }
+        stop(ecto::QUIT);
+      }
+
+      const schedulers::plan& p;
+      //! what the completions of async cells hand out, run while ticks are parked
+      boost::asio::io_service& serv;
+      bool async;
+      //! the only worker runs serv itself when idle, having no execute_impl to do it
+      bool pump;
+      const unsigned niter;
+      std::size_t window;
+
+      //! microseconds, 0 for none
+      const boost::int64_t deadline;
+      //! take the most urgent task, rather than the newest or oldest
+      bool ordered;
+      const boost::posix_time::ptime start;
+      //! ticks released so far, and by tick modulo their size, the times they
+      //! were released, the tick plus one each time is for and the sinks that
+      //! have yet to finish them
+      volatile std::size_t released;
+      std::vector<boost::int64_t> release;
+      std::vector<std::size_t> stamp;
+      std::vector<std::size_t> remaining;
+      boost::mutex deadline_mtx;
+      //! ticks checked, those that finished late and those whose cells were
+      //! not all given the same deadline
+      std::size_t deadline_ticks, deadline_misses, deadline_splits;
+      boost::int64_t worst_lateness;
+
+      std::vector<node> nodes;
+      std::vector<std::size_t> sources, sinks;
+      std::vector<boost::shared_ptr<strand_queue> > strands;
+      std::vector<boost::shared_ptr<task_deque> > deques;
+
+      volatile int stopping;
+      int retval;
+      boost::mutex error_mtx;
+      boost::exception_ptr error;
+
+      //! tasks claimed and not yet finished, and those of them sitting in a deque
+      volatile std::size_t in_flight, queued;
+      volatile std::size_t sleepers;
+      //! workers that have not returned yet
+      volatile std::size_t live;
+      boost::mutex idle_mtx;
+      boost::condition_variable idle;
+    };
+
+    struct dataflow::worker
+    {
+      boost::shared_ptr<state> s;
+
+      typedef void result_type;
+
+      void operator()(unsigned index)
+      {
+        try
+          {
+            //a parked tick's completion may be called later, from a thread
+            //of its own, serv must wait for it rather than run out of work.
+            boost::scoped_ptr<boost::asio::io_service::work> work;
+            if (s->pump)
+              work.reset(new boost::asio::io_service::work(s->serv));
+            task t;
+            for (;;)
+              {
+                if (s->pop(index, t))
+                  {
+                    s->run(index, t);
+                    continue;
+                  }
+                if (s->pump)
+                  {
+                    if (load_acquire(s->in_flight) == 0)
+                      break;
+                    if (!run_one())
+                      {
+                        //stopped by interrupt(), the parked ticks won't resume.
+                        s->stop(ecto::QUIT);
+                        break;
+                      }
+                    continue;
+                  }
+                boost::mutex::scoped_lock lock(s->idle_mtx);
+                fetch_and_add(s->sleepers, std::size_t(1));
+                while (load_acquire(s->queued) == 0 && load_acquire(s->in_flight) != 0)
+                  s->idle.wait(lock);
+                decrement(s->sleepers);
+                if (load_acquire(s->in_flight) == 0)
+                  break;
+              }
+          }
+        catch (const boost::thread_interrupted&)
+          {
+            ECTO_LOG_DEBUG("dataflow worker %u interrupted", index);
+            s->stop(ecto::QUIT);
+          }
+        //the last worker out lets execute_impl stop running the io_service
+        if (decrement(s->live) == 0 && s->async)
+          s->serv.stop();
+      }
+
+      //! one handler of serv, false if it is stopped
+      bool run_one()
+      {
+        try
+          {
+            return s->serv.run_one() != 0;
+          }
+        catch (...)
+          {
+            s->fail(boost::current_exception());
+            return true;
+          }
+      }
+    };
+
+    dataflow::dataflow(plasm_ptr p)
+      : scheduler(p)
+      , ticks_in_flight_(4)
+    { }
+
+    dataflow::~dataflow()
+    {
+      if (!running())
+        return;
+      interrupt();
+      wait();
+    }
+
+    void dataflow::ticks_in_flight(unsigned n)
+    {
+      ticks_in_flight_ = std::max(n, 1u);
+    }
+
+    unsigned dataflow::ticks_in_flight() const
+    {
+      return ticks_in_flight_;
+    }
+
+    int dataflow::execute_impl(unsigned niter, unsigned nthread, boost::asio::io_service& topserv)
+    {
+      ECTO_LOG_DEBUG("execute_impl niter=%u nthread=%u", niter % nthread);
+      profile::graphstats_collector gs(graphstats);
+
+      //
+      //  A cell bound to a NUMA node has its ticks pushed to the workers
+      //  pinned on that node in turn.  They may still be stolen.
+      //
+      std::vector<int> cpu(nthread), homes(plan->steps.size(), -1);
+      for (unsigned j = 0; j < nthread; ++j)
+        cpu[j] = worker_cpu(j);
+      std::map<int, unsigned> turn;
+      for (std::size_t i = 0; i < plan->steps.size(); ++i)
+        {
+          int node = numa_node(plan->steps[i].c);
+          if (node < 0)
+            continue;
+          std::vector<int> local;
+          for (unsigned j = 0; j < nthread; ++j)
+            if (cpu[j] >= 0 && affinity::node_of(cpu[j]) == node)
+              local.push_back(j);
+          if (!local.empty())
+            homes[i] = local[turn[node]++ % local.size()];
+        }
+
+      boost::shared_ptr<state> s(new state(graph, *plan, niter, ticks_in_flight_, nthread, homes,
+                                           plasm->deadline(), topserv));
+      {
+        boost::mutex::scoped_lock lock(state_mtx_);
+        state_ = s;
+      }
+      if (s->async)
+        topserv.reset();
+      for (std::size_t i = 0; i < s->sources.size(); ++i)
+        s->try_schedule(s->sources[i], i % nthread);
+
+      worker w = { s };
+      boost::shared_ptr<thread_pool::crew> c(new thread_pool::crew(thread_pool::shared(), nthread,
+                                                                   w, cpu));
+      {
+        boost::mutex::scoped_lock lock(state_mtx_);
+        crew_ = c;
+      }
+      //the deques of the workers the pool had no thread for are stolen from
+      for (unsigned j = c->size(); j < nthread; ++j)
+        if (decrement(s->live) == 0 && s->async)
+          topserv.stop();
+      //
+      //  Parked ticks of async cells wait on the io_service their
+      //  completions hand out, so run it here until the workers are done.
+      //  A crew that got no pool thread runs its worker here, in join(),
+      //  and that runs the io_service instead.
+      //
+      if (s->async && c->deferred())
+        s->pump = true;
+      else if (s->async)
+        {
+          boost::asio::io_service::work work(topserv);
+          for (;;)
+            {
+              try
+                {
+                  topserv.run();
+                  break;
+                }
+              catch (...)
+                {
+                  s->fail(boost::current_exception());
+                }
+            }
+        }
+      wait_impl();
+      {
+        boost::mutex::scoped_lock lock(state_mtx_);
+        state_.reset();
+      }
+      graphstats.deadline_ticks = s->deadline_ticks;
+      graphstats.deadline_misses = s->deadline_misses;
+      graphstats.deadline_splits = s->deadline_splits;
+      graphstats.worst_lateness = boost::posix_time::microseconds(s->worst_lateness);
+      if (s->error)
+        boost::rethrow_exception(s->error);
+      return s->retval;
+    }
+
+    void dataflow::stop_impl()
+    {
+      boost::shared_ptr<state> s;
+      {
+        boost::mutex::scoped_lock lock(state_mtx_);
+        s = state_;
+      }
+      if (s)
+        s->stop(ecto::QUIT);
+    }
+
+    void dataflow::interrupt_impl()
+    {
+      stop_impl();
+      top_serv.stop();
+      {
+        boost::mutex::scoped_lock lock(state_mtx_);
+        if (crew_)
+          crew_->interrupt();
+      }
+      wait_impl();
+    }
+
+    void dataflow::wait_impl()
+    {
+      boost::shared_ptr<thread_pool::crew> c;
+      {
+        boost::mutex::scoped_lock lock(state_mtx_);
+        c = crew_;
+      }
+      if (c)
+        c->join();
+    }
+  }
+}
@@ -41,6 +41,8 @@
 #include <ecto/edge.hpp>
 
 #include <ecto/impl/graph_types.hpp>
+#include <ecto/impl/invoke.hpp>
+#include <ecto/impl/plan.hpp>
 #include <ecto/impl/schedulers/access.hpp>
 #include <ecto/plasm.hpp>
 
@@ -51,73 +53,296 @@ namespace ecto {
 
   namespace schedulers {
 
+    namespace {
+      //
+      //  Downstream of a lossy edge the inputs may hold values of different
+      //  ticks.  The cell runs the newest tick at the front of any input,
+      //  the older values on the other inputs are discarded, and if one of
+      //  them has no value for that tick (it was dropped) the tick is
+      //  skipped, and the values left are taken on the next call.  The
+      //  cell's tick jumps to the tick it runs, so that its outputs keep
+      //  the ticks of the sources.
+      //
+      bool
+      pull_lossy_inputs(const plan& p, const plan::step& s)
+      {
+        cell& m = *s.c;
+        std::size_t tick = m.tick();
+        for (std::size_t i = s.inputs_begin; i < s.inputs_end; ++i)
+          {
+            std::size_t front;
+            if (!p.inputs[i].edge->front_tick(front))
+              {
+                ECTO_LOG_DEBUG("%s Skipping tick %u, an input was dropped upstream", m.name() % tick);
+                return false;
+              }
+            tick = std::max(tick, front);
+          }
+        m.tick(tick);
+        //a DROP_OLDEST producer may pop the front in between, then what
+        //was taken for the tick is of no use and is overwritten next time.
+        for (std::size_t i = s.inputs_begin; i < s.inputs_end; ++i)
+          if (!p.inputs[i].edge->take_tick(tick, *p.inputs[i].port))
+            {
+              ECTO_LOG_DEBUG("%s Skipping tick %u, an input was dropped upstream", m.name() % tick);
+              return false;
+            }
+        return true;
+      }
+
+      //! take the tick's inputs off the edges, false if the tick was skipped.
+      bool
+      pull_inputs(const plan& p, const plan::step& s, std::size_t tick)
+      {
+        cell& m = *s.c;
+        if (s.lossy)
+          return pull_lossy_inputs(p, s);
+
+        for (std::size_t i = s.inputs_begin; i < s.inputs_end; ++i)
+          {
+            graph::edge& e = *p.inputs[i].edge;
+            tendril& to = *p.inputs[i].port;
+
+            try{
+              e.take_front(to); //the slot is popped right after, so steal its value.
+            }catch(ecto::except::EctoException& ex)
+            {
+
+                    BOOST_THROW_EXCEPTION(except::CellException()
+                                          << except::type(name_of(typeid(ex)))
+                                          << except::what(ex.what())
+                                          << except::cell_name(m.name())
+                                          << except::when(boost::str(boost::format("Copying %s to %s")%e.to_port()%e.from_port()))
+                                                          )
+                                          ;
+              throw;
+            }
+            ECTO_LOG_DEBUG("Moved inputs to cell %s: tick=%u, from.tick=%u", m.name() % tick % to.tick);
+            ECTO_ASSERT(tick == to.tick, "Internal scheduler error, graph has become somehow desynchronized.");
+          }
+        return true;
+      }
+
+      void
+      push_outputs(const plan& p, const plan::step& s, std::size_t tick)
+      {
+        for (std::size_t i = s.outputs_begin; i < s.outputs_end; ++i)
+          {
+            const plan::output& out = p.outputs[i];
+            tendril& from = *out.port;
+            from.tick = tick;
+            // ECTO_LOG_DEBUG("%s Put output with tick %u", m.name() % from.tick);
+            push_output(out, from);
+          }
+      }
+    }
+
+    void
+    push_output(const plan::output& out, tendril& from)
+    {
+      if (from.shared_payload())
+        from.freeze(); //edges and consumers get handles, not copies.
+      if (from.rewritten() && !from.frozen() && out.single_consumer)
+        out.edge->move_back(from); //nobody else reads it, and the cell rewrites it next tick.
+      else
+        out.edge->push_back(from);//copy everything... value, docs, user_defined, etc...
+    }
+
     int
-    invoke_process(graph_t& graph, graph_t::vertex_descriptor vd)
+    invoke_process(const plan& p, std::size_t step)
     {
-      cell::ptr m = graph[vd];
+      const plan::step& s = p.steps[step];
+      cell& m = *s.c;
 
-      std::size_t tick = m->tick();
+      std::size_t tick = m.tick();
 
-      ECTO_LOG_DEBUG(">> process %s tick %u", m->name() % tick);
+      ECTO_LOG_DEBUG(">> process %s tick %u", m.name() % tick);
 
-      if (m->stop_requested()) {
-        ECTO_LOG_DEBUG("%s Not processing because stop_requested", m->name());
+      if (m.stop_requested()) {
+        ECTO_LOG_DEBUG("%s Not processing because stop_requested", m.name());
         return ecto::QUIT;
       }
-      graph_t::in_edge_iterator inbegin, inend;
-      tie(inbegin, inend) = boost::in_edges(vd, graph);
 
-      while (inbegin != inend)
+      if (!pull_inputs(p, s, tick))
+        return ecto::OK;
+      tick = m.tick(); //later than before downstream of a lossy edge
+
+      int rval;
+      try { rval = m.process_running(); } catch (...) { m.stop_requested(true); throw; }
+
+      if(rval != ecto::OK) {
+        ECTO_LOG_DEBUG("** process %s tick %u *BAILOUT*", m.name() % tick);
+        return rval; //short circuit.
+      }
+      push_outputs(p, s, tick);
+      m.inc_tick();
+      // ECTO_LOG_DEBUG("Incrementing tick on %s to %u", m.name() % m.tick());
+      ECTO_LOG_DEBUG("<< process %s tick %u", m.name() % tick);
+      return rval;
+    }
+
+    int
+    start_process(const plan& p, std::size_t step, const completion& c, bool& parked)
+    {
+      const plan::step& s = p.steps[step];
+      cell& m = *s.c;
+      parked = false;
+
+      ECTO_LOG_DEBUG(">> process_async %s tick %u", m.name() % m.tick());
+
+      if (m.stop_requested())
+        return ecto::QUIT;
+      if (!pull_inputs(p, s, m.tick()))
+        return ecto::OK;
+
+      int rval;
+      try { rval = m.process_async(c); } catch (...) { m.stop_requested(true); throw; }
+      parked = true;
+      return rval;
+    }
+
+    int
+    finish_process(const plan& p, std::size_t step, int rval)
+    {
+      const plan::step& s = p.steps[step];
+      cell& m = *s.c;
+      ECTO_LOG_DEBUG("<< process_async %s tick %u", m.name() % m.tick());
+      if (rval != ecto::OK)
+        return rval;
+      push_outputs(p, s, m.tick());
+      m.inc_tick();
+      return ecto::OK;
+    }
+
+    int
+    invoke_process_batch(const plan& p, std::size_t step, std::size_t n)
+    {
+      const plan::step& s = p.steps[step];
+      cell& m = *s.c;
+
+      //downstream of a lossy edge the inputs are lined up tick by tick
+      bool whole = n > 1 && m.batched() && !s.lossy;
+      for (std::size_t i = s.inputs_begin; whole && i < s.inputs_end; ++i)
+        whole = p.inputs[i].edge->size() >= n;
+      if (!whole)
         {
-          edge_ptr e = graph[*inbegin];
-          tendril& from = e->front();
-          tendril& to = *(m->inputs[e->to_port()]);
-          ECTO_LOG_DEBUG("Moving inputs to cell %s: tick=%u, from.tick=%u", m->name() % tick % from.tick);
-          ECTO_ASSERT(tick == from.tick, "Internal scheduler error, graph has become somehow desynchronized.");
-
-          try{
-        	  to << from;
-          }catch(ecto::except::EctoException& ex)
-          {
+          for (std::size_t j = 0; j < n; ++j)
+            {
+              int rval = invoke_process(p, step);
+              if (rval != ecto::OK)
+                return rval;
+            }
+          return ecto::OK;
+        }
 
-                  BOOST_THROW_EXCEPTION(except::CellException()
-                                        << except::type(name_of(typeid(ex)))
-                                        << except::what(ex.what())
-                                        << except::cell_name(m->name())
-                                        << except::when(boost::str(boost::format("Copying %s to %s")%e->to_port()%e->from_port()))
-                                                        )
-                                        ;
-        	  throw;
-          }
-          // ECTO_ASSERT(to.tick == tick, "Graph has become somehow desynchronized");
-          e->pop_front(); //todo Make this use a pool, instead of popping. To get rid of allocations.
-          ++inbegin;
+      std::size_t tick = m.tick();
+      ECTO_LOG_DEBUG(">> process_batch %s ticks %u..%u", m.name() % tick % (tick + n));
+
+      if (m.stop_requested()) {
+        ECTO_LOG_DEBUG("%s Not processing because stop_requested", m.name());
+        return ecto::QUIT;
+      }
+
+      tendrils_batch& in = m.batch_inputs;
+      tendrils_batch& out = m.batch_outputs;
+      in.reset(m.inputs, n);
+      out.reset(m.outputs, n);
+      for (std::size_t i = s.inputs_begin; i < s.inputs_end; ++i)
+        {
+          graph::edge& e = *p.inputs[i].edge;
+          tendrils_batch::column& to = in[e.to_port()];
+          for (std::size_t j = 0; j < n; ++j)
+            e.take_front(to[j]);
+          p.inputs[i].port->copy_value(to[n - 1]); //the ports read as after the last tick
         }
-      //verify that all inputs have been set.
-      m->verify_inputs();
 
       int rval;
-      try { rval = m->process(); } catch (...) { m->stop_requested(true); throw; }
+      try { rval = m.process_batch(in, out, n); } catch (...) { m.stop_requested(true); throw; }
 
       if(rval != ecto::OK) {
-        ECTO_LOG_DEBUG("** process %s tick %u *BAILOUT*", m->name() % tick);
-        return rval; //short circuit.
+        ECTO_LOG_DEBUG("** process_batch %s tick %u *BAILOUT*", m.name() % tick);
+        return rval;
       }
-      graph_t::out_edge_iterator outbegin, outend;
-      tie(outbegin, outend) = boost::out_edges(vd, graph);
-      while (outbegin != outend)
+      for (std::size_t i = s.outputs_begin; i < s.outputs_end; ++i)
         {
-          edge_ptr e = graph[*outbegin];
-          tendril& from = *(m->outputs[e->from_port()]);
-          from.tick = tick;
-          // ECTO_LOG_DEBUG("%s Put output with tick %u", m->name() % from.tick);
-          e->push_back(from);//copy everything... value, docs, user_defined, etc...
-          ++outbegin;
+          const plan::output& o = p.outputs[i];
+          tendrils_batch::column& from = out[o.edge->from_port()];
+          from[n - 1].tick = tick + n - 1;
+          o.port->copy_value(from[n - 1]); //before move_back() takes it
+          for (std::size_t j = 0; j < n; ++j)
+            {
+              from[j].tick = tick + j;
+              push_output(o, from[j]);
+            }
         }
-      m->inc_tick();
-      // ECTO_LOG_DEBUG("Incrementing tick on %s to %u", m->name() % m->tick());
-      ECTO_LOG_DEBUG("<< process %s tick %u", m->name() % tick);
+      for (std::size_t j = 0; j < n; ++j)
+        m.inc_tick();
+      ECTO_LOG_DEBUG("<< process_batch %s ticks %u..%u", m.name() % tick % (tick + n));
       return rval;
     }
+
+    std::size_t
+    batch_limit(const plan& p, std::size_t n)
+    {
+      for (std::size_t i = 0; i < p.inputs.size(); ++i)
+        {
+          const graph::edge& e = *p.inputs[i].edge;
+          if (e.capacity())
+            n = std::min(n, e.capacity());
+        }
+      return std::max<std::size_t>(n, 1);
+    }
+
+    std::size_t
+    in_flight_limit(const plan& p, std::size_t n)
+    {
+      for (std::size_t i = 0; i < p.inputs.size(); ++i)
+        {
+          const graph::edge& e = *p.inputs[i].edge;
+          if (e.capacity() && e.overflow() == graph::edge::BLOCK)
+            n = std::min(n, e.capacity());
+        }
+      return std::max<std::size_t>(n, 1);
+    }
+
+    namespace
+    {
+      //! the step whose output feeds e, p.steps.size() if there is none.
+      std::size_t
+      producer_of(const plan& p, const graph::edge* e)
+      {
+        for (std::size_t s = 0; s < p.steps.size(); ++s)
+          for (std::size_t o = p.steps[s].outputs_begin; o < p.steps[s].outputs_end; ++o)
+            if (p.outputs[o].edge == e)
+              return s;
+        return p.steps.size();
+      }
+    }
+
+    std::size_t
+    strand_limit(const plan& p, std::size_t n, bool threads_for_all)
+    {
+      for (std::size_t c = 0; c < p.steps.size(); ++c)
+        for (std::size_t i = p.steps[c].inputs_begin; i < p.steps[c].inputs_end; ++i)
+          {
+            const graph::edge& e = *p.inputs[i].edge;
+            if (!e.capacity() || e.overflow() != graph::edge::BLOCK || e.capacity() >= n)
+              continue;
+            const std::size_t s = producer_of(p, &e);
+            if (s == p.steps.size())
+              continue;
+            //the ticks ahead of the producer's have passed every step before it
+            const boost::optional<strand>& held = p.steps[s].c->strand_;
+            bool stalls = !threads_for_all;
+            for (std::size_t k = s + 1; held && !stalls && k <= c; ++k)
+              stalls = p.steps[k].c->strand_ && *p.steps[k].c->strand_ == *held;
+            if (!stalls)
+              continue;
+            n = e.capacity();
+            ECTO_LOG_DEBUG("%u ticks in flight at most, %s could wait for room on its edge to %s for good",
+                           n % p.steps[s].c->name() % p.steps[c].c->name());
+          }
+      return std::max<std::size_t>(n, 1);
+    }
   }
 }
@@ -43,6 +43,7 @@
 #include <ecto/impl/invoke.hpp>
 #include <ecto/impl/schedulers/access.hpp>
 #include <ecto/schedulers/multithreaded.hpp>
+#include <ecto/thread_pool.hpp>
 
 #include <boost/thread.hpp>
 #include <boost/scoped_ptr.hpp>
@@ -75,6 +76,16 @@ namespace ecto {
 
     namespace pt = boost::posix_time;
 
+    namespace {
+      //! what the j-th thread borrowed from the pool runs
+      void serve(boost::asio::io_service& workserv, boost::asio::io_service& top_serv,
+                 scheduler* ctx, unsigned j)
+      {
+        boost::function<void()> runit = boost::bind(&verbose_run, boost::ref(workserv),
+                                                    str(boost::format("worker_%u") % j));
+        ecto::except::py::rethrow(runit, top_serv, ctx);
+      }
+    }
 
     //
     // forwarding interface
@@ -117,19 +128,19 @@ namespace ecto {
 
       result_type operator()(std::size_t index)
       {
-        ECTO_ASSERT(index < ctx.stack.size(), "index out of bounds");
-        cell::ptr m = ctx.graph[ctx.stack[index]];
-        access cellaccess(*m);
+        ECTO_ASSERT(index < ctx.plan->steps.size(), "index out of bounds");
+        cell& m = *ctx.plan->steps[index].c;
+        access cellaccess(m);
         ECTO_LOG_DEBUG("Runner firing on cell %u/%u (%s) iter %u",
-                       index % ctx.stack.size() % m->name() % ctx.current_iter.get());
+                       index % ctx.plan->steps.size() % m.name() % ctx.current_iter.get());
         boost::mutex::scoped_lock lock(cellaccess.mtx);
         ECTO_LOG_DEBUG("Runner LOCKED on cell %u/%u (%s) iter %u",
-                       index % ctx.stack.size() % m->name() % ctx.current_iter.get());
+                       index % ctx.plan->steps.size() % m.name() % ctx.current_iter.get());
 
         //
         //  TDS just use multithreaded as context, nix the rethrow?
         //
-        size_t retval = invoke_process(ctx.graph, ctx.stack[index]);
+        size_t retval = invoke_process(*ctx.plan, index);
 
         if (retval != ecto::OK)
           {
@@ -137,10 +148,10 @@ namespace ecto {
             return retval;
           }
         ++index;
-        ECTO_ASSERT (index <= ctx.stack.size(), "index out of bounds");
+        ECTO_ASSERT (index <= ctx.plan->steps.size(), "index out of bounds");
         {
           ecto::atomic<unsigned>::scoped_lock oci(ctx.current_iter);
-          if (index == ctx.stack.size())
+          if (index == ctx.plan->steps.size())
             {
 
               ECTO_LOG_DEBUG("Thread deciding whether to recycle @ index %u, overall iter=%u of %u",
@@ -161,7 +172,7 @@ namespace ecto {
           boost::function<void()> f = boost::bind(stack_runner(ctx,
                                                                max_iter),
                                                   index);
-          on_strand(ctx.graph[ctx.stack[index]], ctx.workserv, boost::bind(&ecto::except::py::rethrow, f,
+          on_strand(ctx.plan->steps[index].c, ctx.workserv, boost::bind(&ecto::except::py::rethrow, f,
                                                  boost::ref(ctx.top_serv), &ctx));
           return retval;
         }
@@ -185,6 +196,12 @@ namespace ecto {
         nthread = max_iter;
         ECTO_LOG_DEBUG("Clamped threads to %u", nthread);
       }
+      //each thread runs its own iteration, and one waiting for room on a BLOCK
+      //edge keeps its thread and strand, see strand_limit.  The pool grows to
+      //nthread, a scheduler running meanwhile may still take an idle thread.
+      thread_pool& pool = thread_pool::shared();
+      const unsigned lendable = pool.idle() + (pool.size() < nthread ? nthread - pool.size() : 0);
+      nthread = unsigned(strand_limit(*plan, nthread, lendable >= nthread));
       for (unsigned j=0; j<nthread; ++j)
         {
           ECTO_LOG_DEBUG("Creating initial stack runner %u of %u", j % nthread);
@@ -196,23 +213,39 @@ namespace ecto {
                                                            boost::ref(top_serv), this));
         }
 
-      ECTO_LOG_DEBUG("Spawning %u workserv runner threads", nthread);
+      ECTO_LOG_DEBUG("Borrowing %u workserv runner threads", nthread);
+      bool deferred = false;
       {
         ecto::atomic<unsigned>::scoped_lock oci(current_iter);
 
+        std::vector<int> cpus(nthread);
         for (unsigned j=0; j<nthread; ++j)
-          {
-            ECTO_LOG_DEBUG("Running service in thread %u", j);
-            std::string thisname = str(boost::format("worker_%u") % j);
-            boost::function<void()> runit = boost::bind(&verbose_run, boost::ref(workserv), thisname);
-            threads.create_thread(boost::bind(&ecto::except::py::rethrow, runit,
-                                              boost::ref(top_serv), this));
-            ++oci.value;
-          }
+          cpus[j] = worker_cpu(j);
+        boost::shared_ptr<thread_pool::crew>
+          c(new thread_pool::crew(thread_pool::shared(), nthread,
+                                  boost::bind(&serve, boost::ref(workserv), boost::ref(top_serv),
+                                              this, _1),
+                                  cpus));
+        ECTO_LOG_DEBUG("Got %u of them", c->size());
+        deferred = c->deferred();
+        {
+          boost::mutex::scoped_lock lock(crew_mtx);
+          crew = c;
+        }
+        oci.value += nthread;
       }
-      verbose_run(top_serv, "top_serv");
-
-      threads.join_all();
+      if (deferred)
+        {
+          //the pool had no thread to lend, this one serves workserv in join().
+          //The runners' rethrows are posted to top_serv, run it after.
+          wait_impl();
+          verbose_run(top_serv, "top_serv");
+        }
+      else
+        {
+          verbose_run(top_serv, "top_serv");
+          wait_impl();
+        }
       {
         ecto::atomic<unsigned>::scoped_lock oci(current_iter);
         ECTO_LOG_DEBUG("JOINED, EXITING AFTER %u of %u", oci.value % max_iter);
@@ -230,8 +263,12 @@ namespace ecto {
 
     void multithreaded::interrupt_impl() {
       stop();
-      threads.interrupt_all();
-      threads.join_all();
+      {
+        boost::mutex::scoped_lock lock(crew_mtx);
+        if (crew)
+          crew->interrupt();
+      }
+      wait_impl();
     }
 
     void multithreaded::stop_impl()
@@ -240,7 +277,13 @@ namespace ecto {
 
     void multithreaded::wait_impl()
     {
-      threads.join_all();
+      boost::shared_ptr<thread_pool::crew> c;
+      {
+        boost::mutex::scoped_lock lock(crew_mtx);
+        c = crew;
+      }
+      if (c)
+        c->join();
     }
   }
 }
@@ -0,0 +1,475 @@
+//
+// Copyright (c) 2011, Willow Garage, Inc.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//     * Neither the name of the Willow Garage, Inc. nor the names of its
+//       contributors may be used to endorse or promote products derived from
+//       this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+#include <ecto/log.hpp>
+#include <ecto/cell.hpp>
+#include <ecto/except.hpp>
+#include <ecto/atomic.hpp>
+#include <ecto/affinity.hpp>
+
+#include <ecto/impl/graph_types.hpp>
+#include <ecto/impl/invoke.hpp>
+#include <ecto/impl/plan.hpp>
+#include <ecto/impl/schedulers/access.hpp>
+#include <ecto/schedulers/pipelined.hpp>
+
+#include <boost/exception_ptr.hpp>
+#include <boost/noncopyable.hpp>
+#include <boost/thread.hpp>
+#include <boost/unordered_map.hpp>
+
+#include <algorithm>
+#include <deque>
+#include <limits>
+#include <vector>
+
+namespace ecto {
+
+  using namespace ecto::except;
+
+  namespace schedulers {
+
+    using namespace ecto::graph;
+
+    namespace {
+
+      //! ticks handed from one stage to the next
+      struct token
+      {
+        std::size_t tick, count;
+        //! a cell upstream failed, don't run this tick
+        bool skip;
+        //! no more ticks
+        bool end;
+      };
+
+      //! the bounded queue into a stage
+      struct handoff : boost::noncopyable
+      {
+        explicit handoff(std::size_t capacity_)
+          : capacity(capacity_)
+        { }
+
+        void push(const token& t)
+        {
+          boost::mutex::scoped_lock lock(mtx);
+          while (q.size() >= capacity)
+            not_full.wait(lock);
+          q.push_back(t);
+          not_empty.notify_one();
+        }
+
+        token pop()
+        {
+          boost::mutex::scoped_lock lock(mtx);
+          while (q.empty())
+            not_empty.wait(lock);
+          token t = q.front();
+          q.pop_front();
+          not_full.notify_one();
+          return t;
+        }
+
+        const std::size_t capacity;
+        boost::mutex mtx;
+        boost::condition_variable not_empty, not_full;
+        std::deque<token> q;
+      };
+    }
+
+    //
+    //  queues[s] feeds stage s.  The last stage feeds queues[0], which is
+    //  primed with max_in_flight tokens: the first stage takes one before it
+    //  starts a tick and the last gives it back when the tick is through, so
+    //  no more than max_in_flight ticks are in the pipeline and no queue is
+    //  ever full.
+    //
+    struct pipelined::state : boost::noncopyable
+    {
+      state(const schedulers::plan& p_, const std::vector<std::vector<std::size_t> >& stages_,
+            unsigned niter_, unsigned window, std::size_t batch_)
+        : p(p_)
+        , stages(stages_)
+        , niter(niter_)
+        , batch(batch_)
+        , stopping(0)
+        , retval(ecto::OK)
+        , strand_of(p.steps.size())
+      {
+        for (std::size_t s = 0; s < stages.size(); ++s)
+          queues.push_back(boost::shared_ptr<handoff>(new handoff(window)));
+        for (unsigned j = 0; j < window; ++j)
+        {
+          token credit = { 0, 0, false, false };
+          queues[0]->push(credit);
+        }
+
+        boost::unordered_map<std::size_t, boost::shared_ptr<boost::mutex> > by_id;
+        for (std::size_t k = 0; k < p.steps.size(); ++k)
+          if (p.steps[k].c->strand_)
+          {
+            boost::shared_ptr<boost::mutex>& m = by_id[p.steps[k].c->strand_->id()];
+            if (!m)
+              m.reset(new boost::mutex);
+            strand_of[k] = m;
+          }
+      }
+
+      void run_stage(std::size_t s)
+      {
+        const std::size_t nstages = stages.size();
+        handoff& in = *queues[s];
+        handoff& out = *queues[(s + 1) % nstages];
+        for (std::size_t t = 0;;)
+        {
+          token tk;
+          if (s == 0)
+          {
+            in.pop(); //a credit
+            if (load_acquire(stopping) || (niter && t >= niter))
+            {
+              token end = { t, 0, true, true };
+              if (nstages > 1)
+                out.push(end);
+              return;
+            }
+            tk.tick = t;
+            tk.count = niter ? std::min(batch, niter - t) : batch;
+            tk.skip = tk.end = false;
+            t += tk.count;
+          }
+          else
+          {
+            tk = in.pop();
+            if (tk.end)
+            {
+              if (s + 1 < nstages)
+                out.push(tk);
+              return;
+            }
+          }
+          if (load_acquire(stopping))
+            tk.skip = true;
+          if (!tk.skip && !run_cells(stages[s], tk.count))
+            tk.skip = true;
+          out.push(tk);
+        }
+      }
+
+      //! false if a cell failed or asked to stop
+      bool run_cells(const std::vector<std::size_t>& steps, std::size_t count)
+      {
+        for (std::size_t j = 0; j < steps.size(); ++j)
+        {
+          std::size_t k = steps[j];
+          cell& m = *p.steps[k].c;
+          access cellaccess(m);
+          try
+          {
+            boost::unique_lock<boost::mutex> strand_lock;
+            if (strand_of[k])
+              strand_lock = boost::unique_lock<boost::mutex>(*strand_of[k]);
+            boost::mutex::scoped_lock lock(cellaccess.mtx);
+            int rv = count > 1
+              ? schedulers::invoke_process_batch(p, k, count)
+              : schedulers::invoke_process(p, k);
+            if (rv != ecto::OK)
+            {
+              cellaccess.stop_requested = true;
+              stop(rv);
+              return false;
+            }
+          }
+          catch (const boost::thread_interrupted&)
+          {
+            throw;
+          }
+          catch (...)
+          {
+            {
+              boost::mutex::scoped_lock lock(error_mtx);
+              if (!error)
+                error = boost::current_exception();
+            }
+            stop(ecto::QUIT);
+            return false;
+          }
+        }
+        return true;
+      }
+
+      void stop(int rv)
+      {
+        if (compare_and_swap(stopping, 0, 1) == 0)
+          retval = rv;
+      }
+
+      const schedulers::plan& p;
+      const std::vector<std::vector<std::size_t> > stages;
+      const unsigned niter;
+      const std::size_t batch;
+      std::vector<boost::shared_ptr<handoff> > queues;
+
+      volatile int stopping;
+      int retval;
+      boost::mutex error_mtx;
+      boost::exception_ptr error;
+
+      //! cells that share a strand share a mutex
+      std::vector<boost::shared_ptr<boost::mutex> > strand_of;
+    };
+
+    struct pipelined::runner
+    {
+      boost::shared_ptr<state> s;
+      std::size_t stage;
+      int cpu;
+
+      void operator()()
+      {
+        if (cpu >= 0)
+          affinity::pin(cpu);
+        try
+        {
+          s->run_stage(stage);
+        }
+        catch (const boost::thread_interrupted&)
+        {
+          ECTO_LOG_DEBUG("pipelined stage %u interrupted", stage);
+          s->stop(ecto::QUIT);
+        }
+      }
+    };
+
+    pipelined::pipelined(plasm_ptr p)
+      : scheduler(p)
+      , nstages_(0)
+      , max_in_flight_(2)
+    { }
+
+    pipelined::~pipelined()
+    {
+      if (!running())
+        return;
+      interrupt();
+      wait();
+    }
+
+    void pipelined::nstages(unsigned n)
+    {
+      nstages_ = n;
+    }
+
+    unsigned pipelined::nstages() const
+    {
+      return nstages_;
+    }
+
+    void pipelined::max_in_flight(unsigned n)
+    {
+      max_in_flight_ = std::max(n, 1u);
+    }
+
+    unsigned pipelined::max_in_flight() const
+    {
+      return max_in_flight_;
+    }
+
+    void pipelined::stage(const cell_ptr& c, unsigned k)
+    {
+      manual_[c] = k;
+    }
+
+    void pipelined::clear_stages()
+    {
+      manual_.clear();
+    }
+
+    std::vector<std::vector<cell_ptr> > pipelined::layout() const
+    {
+      std::vector<std::vector<cell_ptr> > l(stages_.size());
+      for (std::size_t s = 0; s < stages_.size(); ++s)
+        for (std::size_t j = 0; j < stages_[s].size(); ++j)
+          l[s].push_back(graph[stack[stages_[s][j]]]);
+      return l;
+    }
+
+    void pipelined::partition(unsigned nthread)
+    {
+      const std::size_t n = stack.size();
+      std::vector<std::size_t> stage_of(n, 0);
+
+      if (!manual_.empty())
+      {
+        std::vector<std::size_t> position(boost::num_vertices(graph));
+        for (std::size_t k = 0; k < n; ++k)
+          position[stack[k]] = k;
+        for (std::size_t k = 0; k < n; ++k)
+        {
+          std::size_t earliest = 0;
+          graph_t::in_edge_iterator b, e;
+          for (boost::tie(b, e) = boost::in_edges(stack[k], graph); b != e; ++b)
+            earliest = std::max(earliest, stage_of[position[boost::source(*b, graph)]]);
+          std::map<cell_ptr, unsigned>::const_iterator it = manual_.find(graph[stack[k]]);
+          if (it == manual_.end())
+            stage_of[k] = earliest;
+          else if (it->second < earliest)
+            BOOST_THROW_EXCEPTION(EctoException()
+                                  << diag_msg("A cell can't be in an earlier stage than its producers")
+                                  << cell_name(graph[stack[k]]->name()));
+          else
+            stage_of[k] = it->second;
+        }
+      }
+      else
+      {
+        //
+        //  Cut the stack into nstages contiguous runs, minimizing the cost of
+        //  the most expensive one.  A cell's cost is its average process
+        //  time so far, cells that haven't run cost the average of the rest.
+        //
+        std::size_t nstages = std::min<std::size_t>(nstages_ ? nstages_ : nthread, n);
+        nstages = std::max<std::size_t>(nstages, 1);
+        std::vector<double> cost(n, 0);
+        double known = 0;
+        std::size_t nknown = 0;
+        for (std::size_t k = 0; k < n; ++k)
+        {
+          const profile::stats_type& st = graph[stack[k]]->stats;
+          if (st.ncalls)
+          {
+            cost[k] = double(st.total_ticks) / st.ncalls;
+            known += cost[k];
+            ++nknown;
+          }
+        }
+        for (std::size_t k = 0; k < n; ++k)
+          if (!graph[stack[k]]->stats.ncalls)
+            cost[k] = nknown ? known / nknown : 1.0;
+
+        std::vector<double> prefix(n + 1, 0);
+        for (std::size_t k = 0; k < n; ++k)
+          prefix[k + 1] = prefix[k] + cost[k];
+        //best[j][i]: the least max stage cost of the first i cells in j + 1 stages
+        std::vector<std::vector<double> > best(nstages, std::vector<double>(n + 1, 0));
+        std::vector<std::vector<std::size_t> > cut(nstages, std::vector<std::size_t>(n + 1, 0));
+        for (std::size_t i = 1; i <= n; ++i)
+          best[0][i] = prefix[i];
+        for (std::size_t j = 1; j < nstages; ++j)
+          for (std::size_t i = j + 1; i <= n; ++i)
+          {
+            best[j][i] = std::numeric_limits<double>::max();
+            for (std::size_t m = j; m < i; ++m)
+            {
+              double c = std::max(best[j - 1][m], prefix[i] - prefix[m]);
+              if (c < best[j][i])
+              {
+                best[j][i] = c;
+                cut[j][i] = m;
+              }
+            }
+          }
+        std::size_t end = n;
+        for (std::size_t j = nstages; j-- > 0;)
+        {
+          std::size_t begin = j ? cut[j][end] : 0;
+          for (std::size_t k = begin; k < end; ++k)
+            stage_of[k] = j;
+          end = begin;
+        }
+      }
+
+      stages_.clear();
+      std::size_t nstages = 0;
+      for (std::size_t k = 0; k < n; ++k)
+        nstages = std::max(nstages, stage_of[k] + 1);
+      std::vector<std::vector<std::size_t> > stages(nstages);
+      for (std::size_t k = 0; k < n; ++k)
+        stages[stage_of[k]].push_back(k);
+      for (std::size_t s = 0; s < nstages; ++s)
+        if (!stages[s].empty())
+          stages_.push_back(stages[s]);
+    }
+
+    int pipelined::execute_impl(unsigned niter, unsigned nthread, boost::asio::io_service&)
+    {
+      ECTO_LOG_DEBUG("execute_impl niter=%u nthread=%u", niter % nthread);
+      profile::graphstats_collector gs(graphstats);
+
+      partition(nthread);
+      //no more ticks in flight than fit on a BLOCK edge
+      const std::size_t nbatch = batch_limit(*plan, batch());
+      const unsigned window = unsigned(std::max<std::size_t>(
+          in_flight_limit(*plan, max_in_flight_ * nbatch) / nbatch, 1));
+      boost::shared_ptr<state> s(new state(*plan, stages_, niter, window, nbatch));
+      {
+        boost::mutex::scoped_lock lock(state_mtx_);
+        state_ = s;
+      }
+      for (std::size_t j = 0; j < stages_.size(); ++j)
+      {
+        //a stage runs on the node of the first of its cells bound to one
+        int node = -1;
+        for (std::size_t k = 0; k < stages_[j].size() && node < 0; ++k)
+          node = numa_node(graph[stack[stages_[j][k]]]);
+        runner r = { s, j, worker_cpu(j, node) };
+        threads.create_thread(r);
+      }
+      threads.join_all();
+      {
+        boost::mutex::scoped_lock lock(state_mtx_);
+        state_.reset();
+      }
+      if (s->error)
+        boost::rethrow_exception(s->error);
+      return s->retval;
+    }
+
+    void pipelined::stop_impl()
+    {
+      boost::shared_ptr<state> s;
+      {
+        boost::mutex::scoped_lock lock(state_mtx_);
+        s = state_;
+      }
+      if (s)
+        s->stop(ecto::QUIT);
+    }
+
+    void pipelined::interrupt_impl()
+    {
+      stop_impl();
+      threads.interrupt_all();
+      threads.join_all();
+    }
+
+    void pipelined::wait_impl()
+    {
+      threads.join_all();
+    }
+  }
+}
@@ -0,0 +1,86 @@
+//
+// Copyright (c) 2011, Willow Garage, Inc.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//     * Neither the name of the Willow Garage, Inc. nor the names of its
+//       contributors may be used to endorse or promote products derived from
+//       this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+
+#include <ecto/cell.hpp>
+#include <ecto/edge.hpp>
+#include <ecto/tendrils.hpp>
+
+#include <ecto/impl/plan.hpp>
+
+namespace ecto {
+
+  using namespace ecto::graph;
+
+  namespace schedulers {
+
+    plan::plan(graph_t& graph, const std::vector<graph_t::vertex_descriptor>& stack)
+    {
+      steps.reserve(stack.size());
+      std::vector<bool> lossy(boost::num_vertices(graph), false);
+      for (std::size_t j = 0; j < stack.size(); ++j)
+        {
+          graph_t::vertex_descriptor vd = stack[j];
+          step s;
+          s.c = graph[vd];
+          s.vd = vd;
+
+          s.inputs_begin = inputs.size();
+          graph_t::in_edge_iterator inbegin, inend;
+          for (boost::tie(inbegin, inend) = boost::in_edges(vd, graph); inbegin != inend; ++inbegin)
+            {
+              edge_ptr e = graph[*inbegin];
+              input in = { e.get(), s.c->inputs[e->to_port()].get() };
+              inputs.push_back(in);
+              if (e->lossy() || lossy[boost::source(*inbegin, graph)])
+                lossy[vd] = true;
+            }
+          s.inputs_end = inputs.size();
+          s.lossy = lossy[vd];
+
+          s.outputs_begin = outputs.size();
+          graph_t::out_edge_iterator outbegin, outend;
+          for (boost::tie(outbegin, outend) = boost::out_edges(vd, graph); outbegin != outend; ++outbegin)
+            {
+              edge_ptr e = graph[*outbegin];
+              output out = { s.c->outputs[e->from_port()].get(), e.get(), true };
+              outputs.push_back(out);
+            }
+          s.outputs_end = outputs.size();
+
+          //outputs that feed more than one edge have to be copied, not moved.
+          for (std::size_t a = s.outputs_begin; a < s.outputs_end; ++a)
+            for (std::size_t b = s.outputs_begin; b < s.outputs_end; ++b)
+              if (a != b && outputs[a].port == outputs[b].port)
+                outputs[a].single_consumer = false;
+
+          steps.push_back(s);
+        }
+    }
+
+  }
+}
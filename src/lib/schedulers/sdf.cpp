@@ -25,16 +25,45 @@
 // ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
 // POSSIBILITY OF SUCH DAMAGE.
 //
-
 #include <ecto/util.hpp>
 #include <ecto/plasm.hpp>
+#include <ecto/edge.hpp>
+#include <ecto/except.hpp>
 #include <ecto/schedulers/sdf.hpp>
+#include <ecto/tendrils_batch.hpp>
+
+#include <ecto/impl/invoke.hpp>
+#include <ecto/impl/plan.hpp>
+
+#include <boost/format.hpp>
+
+#include <map>
 
 namespace ecto
 {
+  using namespace ecto::except;
 
   namespace schedulers
   {
+    namespace
+    {
+      //! an edge, by the steps and the plan ports at either end
+      struct channel
+      {
+        std::size_t from, to, output, input;
+      };
+
+      std::size_t gcd(std::size_t a, std::size_t b)
+      {
+        while (b)
+        {
+          std::size_t t = a % b;
+          a = b;
+          b = t;
+        }
+        return a;
+      }
+    }
 
     sdf::sdf(plasm_ptr p)
         :
@@ -51,55 +80,320 @@ namespace ecto
       wait();
     }
 
-    struct sdf::runner
+    std::size_t
+    sdf::repetitions(const cell_ptr& c) const
+    {
+      for (std::size_t k = 0; k < repetitions_.size(); ++k)
+        if (graph[stack[k]] == c)
+          return repetitions_[k];
+      return 0;
+    }
+
+    std::size_t
+    sdf::buffer(const cell_ptr& c, const std::string& input) const
+    {
+      if (!plan)
+        return 0;
+      const schedulers::plan& p = *plan;
+      for (std::size_t k = 0; k < p.steps.size(); ++k)
+        if (p.steps[k].c == c)
+          for (std::size_t i = p.steps[k].inputs_begin; i < p.steps[k].inputs_end; ++i)
+            if (p.inputs[i].edge->to_port() == input && i < buffers_.size())
+              return buffers_[i];
+      return 0;
+    }
+
+    const std::vector<std::size_t>&
+    sdf::period() const
     {
-      runner(sdf& sched)
-          :
-            sched(sched),
-            ready(false)
+      return period_;
+    }
+
+    void
+    sdf::compute_stack_impl()
+    {
+      const schedulers::plan& p = *plan;
+      const std::size_t n = p.steps.size();
+
+      input_rates_.resize(p.inputs.size());
+      for (std::size_t i = 0; i < p.inputs.size(); ++i)
+        input_rates_[i] = p.inputs[i].port->rate();
+      output_rates_.resize(p.outputs.size());
+      for (std::size_t o = 0; o < p.outputs.size(); ++o)
+        output_rates_[o] = p.outputs[o].port->rate();
+
+      //a cell with a port of another rate than 1 fires through its process_batch.
+      multirate_.assign(n, false);
+      for (std::size_t k = 0; k < n; ++k)
       {
+        cell& m = *p.steps[k].c;
+        for (tendrils::const_iterator it = m.inputs.begin(); it != m.inputs.end(); ++it)
+          multirate_[k] = multirate_[k] || it->second->rate() != 1;
+        for (tendrils::const_iterator it = m.outputs.begin(); it != m.outputs.end(); ++it)
+          multirate_[k] = multirate_[k] || it->second->rate() != 1;
+        if (multirate_[k] && !m.batched())
+          BOOST_THROW_EXCEPTION(EctoException()
+                                << diag_msg("A cell with a port rate other than 1 needs a process_batch, to take or give that many values per firing")
+                                << cell_name(m.name()));
+      }
+
+      std::map<const graph::edge*, std::size_t> output_of;
+      std::vector<std::size_t> step_of(p.outputs.size());
+      for (std::size_t k = 0; k < n; ++k)
+        for (std::size_t o = p.steps[k].outputs_begin; o < p.steps[k].outputs_end; ++o)
+        {
+          output_of[p.outputs[o].edge] = o;
+          step_of[o] = k;
+        }
+
+      std::vector<channel> channels;
+      std::vector<std::vector<std::size_t> > touching(n), consuming(n);
+      for (std::size_t k = 0; k < n; ++k)
+        for (std::size_t i = p.steps[k].inputs_begin; i < p.steps[k].inputs_end; ++i)
+        {
+          graph::edge& e = *p.inputs[i].edge;
+          if (e.lossy())
+            BOOST_THROW_EXCEPTION(EctoException()
+                                  << diag_msg("The sdf scheduler can't schedule an edge that drops values")
+                                  << from_key(e.from_port())
+                                  << to_key(e.to_port()));
+          std::size_t o = output_of[&e];
+          channel c = { step_of[o], k, o, i };
+          touching[c.from].push_back(channels.size());
+          touching[c.to].push_back(channels.size());
+          consuming[k].push_back(channels.size());
+          channels.push_back(c);
+        }
 
+      //
+      //  The balance equations: along every edge the producer's firings
+      //  times its rate equal the consumer's firings times its rate.  Walk
+      //  each connected component, giving every cell its firings relative to
+      //  the first as a fraction, then scale to the smallest whole numbers.
+      //
+      std::vector<std::size_t> num(n, 0), den(n, 0);
+      repetitions_.assign(n, 0);
+      for (std::size_t root = 0; root < n; ++root)
+      {
+        if (num[root])
+          continue;
+        num[root] = den[root] = 1;
+        std::vector<std::size_t> component(1, root);
+        for (std::size_t next = 0; next < component.size(); ++next)
+        {
+          std::size_t u = component[next];
+          for (std::size_t j = 0; j < touching[u].size(); ++j)
+          {
+            const channel& c = channels[touching[u][j]];
+            std::size_t produced = output_rates_[c.output], consumed = input_rates_[c.input];
+            std::size_t v, vn, vd;
+            if (c.from == u)
+            {
+              v = c.to;
+              vn = num[u] * produced;
+              vd = den[u] * consumed;
+            }
+            else
+            {
+              v = c.from;
+              vn = num[u] * consumed;
+              vd = den[u] * produced;
+            }
+            std::size_t g = gcd(vn, vd);
+            vn /= g;
+            vd /= g;
+            if (!num[v])
+            {
+              num[v] = vn;
+              den[v] = vd;
+              component.push_back(v);
+            }
+            else if (num[v] != vn || den[v] != vd)
+            {
+              graph::edge& e = *p.inputs[c.input].edge;
+              BOOST_THROW_EXCEPTION(EctoException()
+                                    << diag_msg("The port rates admit no periodic schedule, the cells would fire at inconsistent rates")
+                                    << from_key(e.from_port())
+                                    << to_key(e.to_port())
+                                    << cell_name(p.steps[c.to].c->name()));
+            }
+          }
+        }
+        std::size_t lcm = 1;
+        for (std::size_t j = 0; j < component.size(); ++j)
+          lcm = lcm / gcd(lcm, den[component[j]]) * den[component[j]];
+        std::size_t common = 0;
+        for (std::size_t j = 0; j < component.size(); ++j)
+        {
+          std::size_t k = component[j];
+          repetitions_[k] = num[k] * (lcm / den[k]);
+          common = gcd(common, repetitions_[k]);
+        }
+        for (std::size_t j = 0; j < component.size(); ++j)
+          repetitions_[component[j]] /= common;
       }
 
-      int
-      reset_cell(graph::graph_t::vertex_descriptor c)
+      //
+      //  One period, by simulation.  Of the cells with values enough on their
+      //  inputs and firings left, fire the one furthest down the stack:
+      //  consuming as early as possible keeps the buffers small.  The graph
+      //  is acyclic and the rates are consistent, so there always is one.
+      //
+      std::vector<std::size_t> tokens(channels.size(), 0), peak(channels.size(), 0), fired(n, 0);
+      std::size_t total = 0;
+      for (std::size_t k = 0; k < n; ++k)
+        total += repetitions_[k];
+      period_.clear();
+      period_.reserve(total);
+      while (period_.size() < total)
       {
-        int r;
+        std::size_t k = n;
+        for (std::size_t j = n; k == n && j-- > 0;)
         {
-          boost::lock_guard<boost::mutex> lock(mtx);
-          cell = c;
-          r = last_rval;
-          ready = true;
+          if (fired[j] == repetitions_[j])
+            continue;
+          bool ready = true;
+          for (std::size_t c = 0; ready && c < consuming[j].size(); ++c)
+            ready = tokens[consuming[j][c]] >= input_rates_[channels[consuming[j][c]].input];
+          if (ready)
+            k = j;
         }
-        cond.notify_one();
-        return r;
+        ECTO_ASSERT(k != n, "sdf: no cell can fire, the stack is not in topological order");
+        for (std::size_t j = 0; j < touching[k].size(); ++j)
+        {
+          std::size_t ch = touching[k][j];
+          const channel& c = channels[ch];
+          if (c.to == k)
+            tokens[ch] -= input_rates_[c.input];
+          if (c.from == k)
+          {
+            tokens[ch] += output_rates_[c.output];
+            peak[ch] = std::max(peak[ch], tokens[ch]);
+          }
+        }
+        ++fired[k];
+        period_.push_back(k);
       }
-      ;
-      void
-      operator()()
+
+      //the schedule never holds more than peak values on an edge, each is
+      //bounded to that for the run.  A bounded edge with less room would
+      //block the only thread for good.
+      buffers_.assign(p.inputs.size(), 0);
+      for (std::size_t ch = 0; ch < channels.size(); ++ch)
+      {
+        graph::edge& e = *p.inputs[channels[ch].input].edge;
+        if (e.capacity() && e.capacity() < peak[ch])
+          BOOST_THROW_EXCEPTION(EctoException()
+                                << diag_msg(boost::str(boost::format("The sdf schedule holds up to %u values on an edge bounded to %u")
+                                                       % peak[ch] % e.capacity()))
+                                << from_key(e.from_port())
+                                << to_key(e.to_port())
+                                << cell_name(p.steps[channels[ch].to].c->name()));
+        buffers_[channels[ch].input] = peak[ch];
+      }
+      ECTO_LOG_DEBUG("sdf period of %u firings over %u cells", total % n);
+    }
+
+    int
+    sdf::fire(std::size_t k)
+    {
+      const schedulers::plan& p = *plan;
+      const schedulers::plan::step& s = p.steps[k];
+      cell& m = *s.c;
+
+      if (m.stop_requested())
+        return ecto::QUIT;
+
+      if (!multirate_[k])
       {
-        while (true)
+        for (std::size_t i = s.inputs_begin; i < s.inputs_end; ++i)
+          p.inputs[i].edge->take_front(*p.inputs[i].port);
+
+        int rval;
+        try { rval = m.process_running(); } catch (...) { m.stop_requested(true); throw; }
+        if (rval != ecto::OK)
+          return rval;
+
+        for (std::size_t o = s.outputs_begin; o < s.outputs_end; ++o)
         {
+          const schedulers::plan::output& out = p.outputs[o];
+          tendril& from = *out.port;
+          from.tick = m.tick();
+          schedulers::push_output(out, from);
+        }
+        m.inc_tick();
+        return rval;
+      }
+
+      //
+      //  A port of rate n has a column of n values, the cell's process_batch
+      //  consumes and produces all of them in one firing.  The ports are
+      //  left holding the last of each, as after n single rate firings.
+      //
+      tendrils_batch& in = m.batch_inputs;
+      tendrils_batch& out = m.batch_outputs;
+      in.reset_rates(m.inputs);
+      out.reset_rates(m.outputs);
+      for (std::size_t i = s.inputs_begin; i < s.inputs_end; ++i)
+      {
+        graph::edge& e = *p.inputs[i].edge;
+        tendrils_batch::column& to = in[e.to_port()];
+        for (std::size_t r = 0; r < to.size(); ++r)
+          e.take_front(to[r]);
+        p.inputs[i].port->copy_value(to.back());
+      }
+
+      int rval;
+      try { rval = m.process_batch(in, out, 1); } catch (...) { m.stop_requested(true); throw; }
+      if (rval != ecto::OK)
+        return rval;
+
+      for (std::size_t o = s.outputs_begin; o < s.outputs_end; ++o)
+      {
+        const schedulers::plan::output& po = p.outputs[o];
+        tendrils_batch::column& from = out[po.edge->from_port()];
+        for (std::size_t r = 0; r < from.size(); ++r)
+          from[r].tick = m.tick();
+        po.port->copy_value(from.back()); //before move_back() takes it
+        for (std::size_t r = 0; r < from.size(); ++r)
+          schedulers::push_output(po, from[r]);
+      }
+      m.inc_tick();
+      return rval;
+    }
 
-          boost::unique_lock<boost::mutex> lock(mtx);
-          if (last_rval)
-            break;
-          while (!ready)
+    namespace
+    {
+      //! the edges of the plan bounded to the schedule's peaks for a run, as they were after it.
+      struct rebound : boost::noncopyable
+      {
+        rebound(const schedulers::plan& p, const std::vector<std::size_t>& peaks)
+        {
+          for (std::size_t i = 0; i < p.inputs.size(); ++i)
           {
-            cond.wait(lock);
+            graph::edge& e = *p.inputs[i].edge;
+            saved s = { &e, e.capacity(), e.overflow() };
+            e.bound(peaks[i], graph::edge::BLOCK);
+            edges.push_back(s);
           }
-          last_rval = sched.invoke_process(cell);
-          ready = false;
         }
-      }
 
-      sdf& sched;
-      boost::mutex mtx;
-      boost::condition_variable cond;
-      graph::graph_t::vertex_descriptor cell;
-      bool ready;
-      int last_rval;
-    };
+        ~rebound()
+        {
+          //the schedule never holds more than the peaks, which fit the old bounds.
+          for (std::size_t i = 0; i < edges.size(); ++i)
+            edges[i].e->bound(edges[i].capacity, edges[i].policy);
+        }
+
+        struct saved
+        {
+          graph::edge* e;
+          std::size_t capacity;
+          graph::edge::overflow_policy policy;
+        };
+        std::vector<saved> edges;
+      };
+    }
 
     int
     sdf::execute_impl(unsigned niter, unsigned nthread, boost::asio::io_service& topserv)
@@ -107,26 +401,32 @@ namespace ecto
       ECTO_START();
       interupted_ = false;
       profile::graphstats_collector gs(graphstats);
+      rebound bounds(*plan, buffers_);
 
-      size_t retval = ecto::OK;
-      unsigned cur_iter = 0;
-      while ((niter == 0 || cur_iter < niter))
+      int retval = ecto::OK;
+      for (unsigned cur_iter = 0; niter == 0 || cur_iter < niter; ++cur_iter)
       {
-        for (size_t k = 0; k < stack.size(); ++k)
+        for (std::size_t j = 0; j < period_.size(); ++j)
         {
           if (interupted_)
-          {
             return ecto::QUIT; //someone interrupted.
-          }ECTO_LOG_DEBUG("k=%u niter=%u", k % niter);
-          //need to check the return val of a process here, non zero means exit...
-          retval = invoke_process(stack[k]);
-          if (retval)
+          try
           {
-            return retval;
+            retval = fire(period_[j]);
+          } catch (const boost::thread_interrupted&)
+          {
+            return ecto::QUIT;
+          } catch (...)
+          {
+            ECTO_LOG_DEBUG("%s", "STOPPING... somebody done threw something.");
+            stop();
+            throw;
           }
+          if (retval)
+            return retval;
         }
-        ++cur_iter;
-      }ECTO_LOG_DEBUG("FINISH %s", __PRETTY_FUNCTION__);
+      }
+      ECTO_LOG_DEBUG("FINISH %s", __PRETTY_FUNCTION__);
       return retval;
     }
 
@@ -139,7 +439,7 @@ namespace ecto
     void
     sdf::stop_impl()
     {
-      //nothing special to do here.. invoke_process takes care of this.
+      //nothing special to do here.. fire takes care of this.
     }
     void
     sdf::wait_impl()
@@ -147,4 +447,3 @@ namespace ecto
     }
   }
 }
-
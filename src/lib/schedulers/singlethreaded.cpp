@@ -29,6 +29,9 @@
 #include <ecto/util.hpp>
 #include <ecto/plasm.hpp>
 #include <ecto/schedulers/singlethreaded.hpp>
+#include <ecto/impl/invoke.hpp>
+
+#include <algorithm>
 
 namespace ecto {
 
@@ -54,8 +57,10 @@ namespace ecto {
 
       size_t retval = ecto::OK;
       unsigned cur_iter = 0;
+      const unsigned nbatch = unsigned(schedulers::batch_limit(*plan, batch()));
       while((niter == 0 || cur_iter < niter))
         {
+          unsigned n = niter == 0 ? nbatch : std::min(nbatch, niter - cur_iter);
           for (size_t k = 0; k < stack.size(); ++k)
             {
               if(interupted_){
@@ -63,12 +68,12 @@ namespace ecto {
               }
               ECTO_LOG_DEBUG("k=%u niter=%u", k % niter);
               //need to check the return val of a process here, non zero means exit...
-              retval = invoke_process(stack[k]);
+              retval = invoke_process(k, n);
               if (retval) {
                 return retval;
               }
             }
-          ++cur_iter;
+          cur_iter += n;
         }
       ECTO_LOG_DEBUG("FINISH %s", __PRETTY_FUNCTION__);
       return retval;
@@ -97,13 +97,23 @@ namespace ecto
   {
     std::string typename_;
     if (typename Archive::is_saving()) 
-      typename_ = type_ID_;
+      typename_ = type_name();
+
+    std::string doc_str;
+    if (typename Archive::is_saving())
+      doc_str = doc();
 
     ar & typename_;
-    ar & doc_;
+    ar & doc_str;
+
+    if (typename Archive::is_loading())
+      set_doc(doc_str);
 
+    const type_ops* type = typename Archive::is_saving() ? type_ : types::by_name(typename_);
+    if (!type)
+      throw std::logic_error("Could not find a serializer registered for the type: " + typename_);
     ecto::serialization::registry<Archive>::instance()
-      .serialize(typename_, ar, const_cast< ::ecto::tendril&>(*this));
+      .serialize(*type, ar, const_cast< ::ecto::tendril&>(*this));
   }
 
   ECTO_INSTANTIATE_SERIALIZATION(tendril);
@@ -112,6 +122,8 @@ namespace ecto
   void
   tendrils::serialize(Archive & ar, const unsigned int version)
   {
+    if (typename Archive::is_loading())
+      thaw();
     ar & storage;
   }
   ECTO_INSTANTIATE_SERIALIZATION(tendrils);
@@ -120,27 +132,14 @@ namespace ecto
   {
     template<typename Archive>
     void
-    registry<Archive>::serialize(const std::string& key, Archive& ar, tendril& t) const
-    {
-      typename serial_map_t::const_iterator it = serial_map.find(key);
-      if (it == serial_map.end())
-      {
-        throw std::logic_error("Could not find a serializer registered for the type: " + key);
-      }
-      it->second(ar, t);
-    }
-
-    template<typename Archive>
-    void
-    registry<Archive>::add(const std::string& name, serial_fn_t fnc)
+    registry<Archive>::serialize(const type_ops& type, Archive& ar, tendril& t) const
     {
-      typename serial_map_t::iterator it;
-      bool inserted;
-      ::boost::tie(it, inserted) = serial_map.insert(std::make_pair(name, fnc));
-      if (!inserted)
+      type_ops::serialize_fn f = type.serialize[archive_index<Archive>::value];
+      if (!f)
       {
-        std::cerr << "Warning: ignoring non novel serialization for " << name << "." << std::endl;
+        throw std::logic_error("Could not find a serializer registered for the type: " + type.name());
       }
+      f(&ar, t);
     }
 
     template<typename Archive>
@@ -27,14 +27,13 @@
 // 
 #include <ecto/tendril.hpp>
 #include <boost/python.hpp>
+#include <boost/make_shared.hpp>
 namespace ecto
 {
   using namespace except;
 
   tendril::tendril()
-    : doc_()
-    , flags_()
-    , converter(&ConverterImpl<none>::instance)
+    : flags_()
     , tick(0)
   {
     set_holder<none>(none());
@@ -42,10 +41,10 @@ namespace ecto
 
   tendril::tendril(const tendril& rhs) 
     : holder_(rhs.holder_)
-    , type_ID_(rhs.type_ID_)
-    , doc_(rhs.doc_)
+    , payload_(rhs.payload_)
+    , type_(rhs.type_)
+    , meta_(copy_meta(rhs.meta_))
     , flags_(rhs.flags_)
-    , converter(rhs.converter)
     , tick(rhs.tick)
   { }
 
@@ -54,15 +53,59 @@ namespace ecto
     if (this == &rhs)
       return *this;
     copy_holder(rhs);
-    doc_ = rhs.doc_;
+    assign_meta(rhs);
     flags_ = rhs.flags_;
-    converter = rhs.converter;
     tick = rhs.tick;
     return *this;
   }
 
+#if !defined(BOOST_NO_RVALUE_REFERENCES)
+  tendril::tendril(tendril&& rhs)
+    : flags_()
+    , tick(0)
+  {
+    set_holder<none>(none());
+    *this = static_cast<tendril&&>(rhs);
+  }
+
+  tendril& tendril::operator=(tendril&& rhs)
+  {
+    if (this == &rhs)
+      return *this;
+    holder_.swap(rhs.holder_);
+    payload_.swap(rhs.payload_);
+    std::swap(type_, rhs.type_);
+    assign_meta(rhs);
+    flags_ = rhs.flags_;
+    tick = rhs.tick;
+    return *this;
+  }
+#endif
+
   tendril::~tendril(){ }
 
+  tendril& tendril::move_from(tendril& rhs)
+  {
+    if (this == &rhs)
+      return *this;
+    if (!payload_ && !rhs.payload_ && same_type(rhs))
+    {
+      holder_.swap(rhs.holder_);
+      tick = rhs.tick;
+      user_supplied(true);
+      return *this;
+    }
+    return *this << rhs;
+  }
+
+  void tendril::copy_value(const tendril& rhs)
+  {
+    if (this == &rhs)
+      return;
+    copy_holder(rhs);
+    tick = rhs.tick;
+  }
+
   ecto::tendril& tendril::operator<<(const tendril& rhs)
   {
     if (this == &rhs)
@@ -85,7 +128,7 @@ namespace ecto
       }
       else if (is_type<boost::python::object>())
       {
-        (*rhs.converter)(*boost::unsafe_any_cast<boost::python::object>(&holder_), rhs);
+        rhs.type_->to_python(unsafe_get<boost::python::object>(), rhs);
       }
     }
     user_supplied(true);
@@ -93,16 +136,56 @@ namespace ecto
   }
 
 
+  tendril::meta& tendril::mutable_meta()
+  {
+    if (!meta_)
+      meta_.reset(new meta);
+    else if (!meta_.unique())
+      meta_ = unshared(*meta_); //the copies keep what they had
+    return *meta_;
+  }
+
+  boost::shared_ptr<tendril::meta> tendril::unshared(const meta& m)
+  {
+    boost::shared_ptr<meta> c(new meta);
+    c->doc = m.doc;
+    c->rate = m.rate;
+    return c;
+  }
+
+  boost::shared_ptr<tendril::meta> tendril::copy_meta(const boost::shared_ptr<meta>& m)
+  {
+    if (!m || (m->jobs.empty() && m->watchers.empty()))
+      return m;
+    return unshared(*m);
+  }
+
+  void tendril::assign_meta(const tendril& rhs)
+  {
+    if (meta_ == rhs.meta_)
+      return;
+    if (meta_ && (!meta_->jobs.empty() || !meta_->watchers.empty()))
+    {
+      //never shared, see copy_meta(), so it can just be written.
+      meta_->doc = rhs.doc();
+      meta_->rate = rhs.rate();
+    }
+    else
+      meta_ = copy_meta(rhs.meta_);
+  }
+
   void tendril::set_doc(const std::string& doc_str)
   {
-    doc_ = doc_str;
+    if (doc_str.empty() && !meta_)
+      return;
+    mutable_meta().doc = doc_str;
   }
 
   void tendril::notify()
   {
-    if (dirty())
+    if (dirty() && meta_)
     {
-      jobs_(*this);
+      meta_->jobs(*this);
     }
     dirty(false);
   }
@@ -110,13 +193,13 @@ namespace ecto
   std::string
   tendril::doc() const
   {
-    return doc_;
+    return meta_ ? meta_->doc : std::string();
   }
 
   std::string
   tendril::type_name() const
   {
-   return type_ID_;
+   return type_->name();
   }
 
   bool
@@ -159,12 +242,17 @@ namespace ecto
   tendril::dirty(bool dirty)
   {
     flags_[DIRTY] = dirty;
+    if (!dirty || !meta_)
+      return;
+    for (std::size_t i = 0; i < meta_->watchers.size(); ++i)
+      if (dirty_list_ptr l = meta_->watchers[i].list.lock())
+        l->push(meta_->watchers[i].n);
   }
 
   bool
   tendril::same_type(const tendril& rhs) const
   {
-    return rhs.type_ID_ == type_ID_;
+    return rhs.type_ == type_;
   }
 
   bool
@@ -189,15 +277,88 @@ namespace ecto
 
   void tendril::copy_holder(const tendril& rhs)
   {
-    holder_ = rhs.holder_;
-    type_ID_ = rhs.type_ID_;
-    converter = rhs.converter;
+    if (rhs.payload_)
+    {
+      //share the frozen value, holder_ goes stale but is kept for reuse.
+      payload_ = rhs.payload_;
+    }
+    else if (!payload_ && same_type(rhs))
+    {
+      //reuse our holder, so that steady state copies don't allocate.
+      holder_ = rhs.holder_;
+      return;
+    }
+    else
+    {
+      payload_.reset();
+      holder_ = rhs.holder_; //in place if the stale holder has the same type.
+    }
+    type_ = rhs.type_;
+  }
+
+  void tendril::freeze()
+  {
+    if (payload_)
+      return;
+    payload_ = boost::make_shared<holder>();
+    payload_->swap(holder_);
+  }
+
+  void tendril::thaw()
+  {
+    if (payload_.unique())
+      holder_.swap(*payload_); //nobody else is looking, take it back.
+    else
+      holder_ = *payload_; //in place if the stale holder has the same type.
+    payload_.reset();
+  }
+
+  bool
+  tendril::rewritten() const
+  {
+    return flags_[REWRITTEN];
+  }
+
+  void
+  tendril::rewritten(bool b)
+  {
+    flags_[REWRITTEN] = b;
+  }
+
+  bool
+  tendril::shared_payload() const
+  {
+    return flags_[SHARED_PAYLOAD];
+  }
+
+  void
+  tendril::shared_payload(bool b)
+  {
+    flags_[SHARED_PAYLOAD] = b;
+  }
+
+  void
+  tendril::rate(unsigned r)
+  {
+    if (r == 0)
+      BOOST_THROW_EXCEPTION(except::EctoException()
+                            << except::diag_msg("A port's rate must be at least 1"));
+    if (r == 1 && !meta_)
+      return;
+    mutable_meta().rate = r;
+  }
+
+  unsigned
+  tendril::rate() const
+  {
+    return meta_ ? meta_->rate : 1;
   }
 
   void tendril::operator<<(const boost::python::object& obj)
   {
     if (is_type<boost::python::object>())
       {
+        payload_.reset();
         holder_ = obj;
       }
     else if (is_type<none>())
@@ -205,7 +366,7 @@ namespace ecto
         set_holder(obj);
       }
     else
-      (*converter)(*this, obj);
+      type_->from_python(*this, obj);
   }
 
   void
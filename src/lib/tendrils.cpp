@@ -28,8 +28,8 @@
 #include <boost/python.hpp>
 #include <ecto/tendrils.hpp>
 #include <boost/algorithm/string.hpp>
-#include <boost/function.hpp>
 #include <map>
+#include <algorithm>
 #include <iostream>
 namespace ecto
 {
@@ -52,29 +52,25 @@ namespace ecto
       out << std::string( bp::extract<std::string>(bp::str(o)));
     }
   }
+  //! Sets type_ops::print for the types we know how to print.
   struct PrintFunctions
   {
-
-    typedef boost::function<void(std::ostream& out, const tendril& x)> function_t;
-    typedef std::map<const char*,function_t> ProcMap;
-    ProcMap processes;
     PrintFunctions()
     {
-      processes[ecto::name_of<int>().c_str()] = function_t(print<int>);
-      processes[ecto::name_of<float>().c_str()] = function_t(print<float>);
-      processes[ecto::name_of<double>().c_str()] = function_t(print<double>);
-      processes[ecto::name_of<bool>().c_str()] = function_t(print<bool>);
-      processes[ecto::name_of<std::string>().c_str()] = function_t(print<std::string>);
-      processes[ecto::name_of<boost::python::api::object>().c_str()] = function_t(print<boost::python::api::object>);
+      types::of<int>().print = &print<int>;
+      types::of<float>().print = &print<float>;
+      types::of<double>().print = &print<double>;
+      types::of<bool>().print = &print<bool>;
+      types::of<std::string>().print = &print<std::string>;
+      types::of<boost::python::api::object>().print = &print<boost::python::api::object>;
     }
 
     void
     print_tendril(std::ostream& out, const tendril& t) const
     {
-      ProcMap::const_iterator it = processes.find(t.type_id());
-      if (it != processes.end())
+      if (t.type().print)
       {
-        it->second(out, t);
+        t.type().print(out, t);
       }
       else
       {
@@ -134,7 +130,9 @@ namespace ecto
 
   //////////////////////////////////////////////////////////////////////////////
 
-  tendrils::tendrils() { }
+  tendrils::tendrils()
+    : frozen_(false)
+  { }
 
   void
   tendrils::print_doc(std::ostream& out, const std::string& tendrils_name) const
@@ -160,6 +158,8 @@ namespace ecto
   const tendril_ptr&
   tendrils::operator[](const std::string& name) const
   {
+    if (frozen_)
+      return at(handle(name));
     boost::mutex::scoped_lock lock(mtx);
     storage_type::const_iterator it = storage.find(name);
     if (it == end())
@@ -170,6 +170,8 @@ namespace ecto
   tendril_ptr&
   tendrils::operator[](const std::string& name)
   {
+    if (frozen_)
+      return at(handle(name));
     boost::mutex::scoped_lock lock(mtx);
     storage_type::iterator it = storage.find(name);
     if (it == end())
@@ -177,9 +179,62 @@ namespace ecto
     return it->second;
   }
 
+  void
+  tendrils::freeze()
+  {
+    if (frozen_)
+      return;
+    boost::mutex::scoped_lock lock(mtx);
+    ports_.clear();
+    ports_.reserve(storage.size());
+    for (iterator it = storage.begin(); it != storage.end(); ++it)
+      ports_.push_back(&*it);
+    frozen_ = true;
+  }
+
+  void
+  tendrils::thaw()
+  {
+    boost::mutex::scoped_lock lock(mtx);
+    frozen_ = false;
+    ports_.clear();
+  }
+
+  namespace
+  {
+    struct key_less
+    {
+      bool
+      operator()(const tendrils::value_type* lhs, const std::string& rhs) const
+      {
+        return lhs->first < rhs;
+      }
+    };
+  }
+
+  tendrils::port_handle
+  tendrils::lower_bound(const std::string& name) const
+  {
+    return std::lower_bound(ports_.begin(), ports_.end(), name, key_less()) - ports_.begin();
+  }
+
+  tendrils::port_handle
+  tendrils::handle(const std::string& name) const
+  {
+    if (!frozen_)
+      BOOST_THROW_EXCEPTION(except::EctoException()
+                            << except::diag_msg("Port handles are only valid once the tendrils are frozen")
+                            << except::tendril_key(name));
+    port_handle h = lower_bound(name);
+    if (h == ports_.size() || ports_[h]->first != name)
+      doesnt_exist(name);
+    return h;
+  }
+
   tendril_ptr
   tendrils::declare(const std::string& name, tendril_ptr t)
   {
+    thaw();
     storage_type::iterator it = find(name);
     //if there are no exiting tendrils by the given name,
     //just add it.
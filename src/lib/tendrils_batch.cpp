@@ -0,0 +1,124 @@
+// 
+// Copyright (c) 2011, Willow Garage, Inc.
+// All rights reserved.
+// 
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//     * Neither the name of the Willow Garage, Inc. nor the names of its
+//       contributors may be used to endorse or promote products derived from
+//       this software without specific prior written permission.
+// 
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+// 
+#include <ecto/tendrils_batch.hpp>
+#include <ecto/tendrils.hpp>
+#include <ecto/except.hpp>
+
+#include <sstream>
+
+namespace ecto
+{
+  tendrils_batch::tendrils_batch()
+    : ticks_(0)
+  { }
+
+  void
+  tendrils_batch::reset(const tendrils& ports, std::size_t n)
+  {
+    layout(ports);
+    std::size_t j = 0;
+    for (tendrils::const_iterator it = ports.begin(); it != ports.end(); ++it, ++j)
+      columns_[j].second.resize(n, *it->second);
+    ticks_ = n;
+  }
+
+  void
+  tendrils_batch::reset_rates(const tendrils& ports)
+  {
+    layout(ports);
+    std::size_t j = 0;
+    for (tendrils::const_iterator it = ports.begin(); it != ports.end(); ++it, ++j)
+      columns_[j].second.resize(it->second->rate(), *it->second);
+    ticks_ = 1;
+  }
+
+  void
+  tendrils_batch::layout(const tendrils& ports)
+  {
+    bool same = columns_.size() == ports.size();
+    std::size_t j = 0;
+    for (tendrils::const_iterator it = ports.begin(); same && it != ports.end(); ++it, ++j)
+      same = columns_[j].first == it->first;
+    if (!same)
+    {
+      columns_.clear();
+      for (tendrils::const_iterator it = ports.begin(); it != ports.end(); ++it)
+        columns_.push_back(std::make_pair(it->first, column()));
+    }
+  }
+
+  bool
+  tendrils_batch::has(const std::string& key) const
+  {
+    std::size_t j = lower_bound(key);
+    return j < columns_.size() && columns_[j].first == key;
+  }
+
+  tendrils_batch::column&
+  tendrils_batch::operator[](const std::string& key)
+  {
+    return columns_[find(key)].second;
+  }
+
+  const tendrils_batch::column&
+  tendrils_batch::operator[](const std::string& key) const
+  {
+    return columns_[find(key)].second;
+  }
+
+  std::size_t
+  tendrils_batch::lower_bound(const std::string& key) const
+  {
+    std::size_t lo = 0, hi = columns_.size();
+    while (lo < hi)
+    {
+      std::size_t mid = (lo + hi) / 2;
+      if (columns_[mid].first < key)
+        lo = mid + 1;
+      else
+        hi = mid;
+    }
+    return lo;
+  }
+
+  std::size_t
+  tendrils_batch::find(const std::string& key) const
+  {
+    std::size_t j = lower_bound(key);
+    if (j == columns_.size() || columns_[j].first != key)
+    {
+      std::stringstream ss;
+      for (std::size_t k = 0; k < columns_.size(); ++k)
+        ss << columns_[k].first << " ";
+      BOOST_THROW_EXCEPTION(except::NonExistant()
+                            << except::tendril_key(key)
+                            << except::actualkeys_hint(ss.str()));
+    }
+    return j;
+  }
+}
@@ -0,0 +1,323 @@
+//
+// Copyright (c) 2011, Willow Garage, Inc.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//     * Neither the name of the Willow Garage, Inc. nor the names of its
+//       contributors may be used to endorse or promote products derived from
+//       this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+#include <ecto/thread_pool.hpp>
+#include <ecto/affinity.hpp>
+#include <ecto/log.hpp>
+
+#include <boost/bind.hpp>
+#include <boost/exception_ptr.hpp>
+#include <boost/lexical_cast.hpp>
+#include <boost/thread.hpp>
+
+#include <algorithm>
+#include <cstdlib>
+
+namespace ecto
+{
+  struct thread_pool::crew::impl
+  {
+    impl(const job& j_)
+      : j(j_), remaining(0), deferred(false)
+    { }
+
+    job j;
+    //! threads of the crew still in j, guarded by the pool's mutex
+    unsigned remaining;
+    //! the pool threads lent to the crew
+    std::vector<unsigned> slots;
+    //! the pool had no idle thread, j(0) is left to the first join(), guarded by the pool's mutex
+    bool deferred;
+    boost::exception_ptr error;
+  };
+
+  struct thread_pool::impl
+  {
+    struct slot
+    {
+      boost::shared_ptr<crew::impl> borrower;
+      unsigned index;
+      int cpu;
+      boost::condition_variable lent;
+      boost::thread* thread;
+    };
+
+    explicit impl(unsigned nthread)
+      : home(affinity::cpus()), quitting(false)
+    {
+      boost::mutex::scoped_lock lock(mtx);
+      grow(nthread);
+    }
+
+    //! start threads up to nthread in all, with mtx locked
+    void grow(unsigned nthread)
+    {
+      for (unsigned s = unsigned(slots.size()); s < nthread; ++s)
+        {
+          slots.push_back(boost::shared_ptr<slot>(new slot));
+          slots[s]->thread = threads.create_thread(boost::bind(&impl::run, this, s));
+          idle.push_back(s);
+        }
+    }
+
+    ~impl()
+    {
+      {
+        boost::mutex::scoped_lock lock(mtx);
+        quitting = true;
+        for (std::size_t s = 0; s < slots.size(); ++s)
+          slots[s]->lent.notify_one();
+      }
+      threads.join_all();
+    }
+
+    //! j(index) pinned to cpu, unpinned back to home after, and its error
+    static boost::exception_ptr work(crew::impl& c, unsigned index, int cpu, const std::vector<unsigned>& home)
+    {
+      if (cpu >= 0)
+        affinity::pin(unsigned(cpu));
+      boost::exception_ptr e;
+      try
+        {
+          c.j(index);
+        }
+      catch (const boost::thread_interrupted&)
+        {
+          ECTO_LOG_DEBUG("pool thread interrupted in job %u", index);
+        }
+      catch (...)
+        {
+          e = boost::current_exception();
+        }
+      if (cpu >= 0)
+        affinity::pin(home);
+      return e;
+    }
+
+    //! the end of one thread's part of c's job
+    void returned(crew::impl& c, const boost::exception_ptr& e)
+    {
+      if (e && !c.error)
+        c.error = e;
+      if (--c.remaining == 0)
+        done.notify_all();
+    }
+
+    void run(unsigned s)
+    {
+      //the thread that grew the pool may have been pinned
+      affinity::pin(home);
+      boost::mutex::scoped_lock lock(mtx);
+      slot& me = *slots[s];
+      for (;;)
+        {
+          while (!me.borrower && !quitting)
+            me.lent.wait(lock);
+          if (!me.borrower)
+            return;
+          boost::shared_ptr<crew::impl> c = me.borrower;
+          lock.unlock();
+          boost::exception_ptr e = work(*c, me.index, me.cpu, home);
+          lock.lock();
+          me.borrower.reset();
+          idle.push_back(s);
+          returned(*c, e);
+          lock.unlock();
+          //an interrupt that came after the job returned was meant for it
+          try
+            {
+              boost::this_thread::interruption_point();
+            }
+          catch (const boost::thread_interrupted&)
+            { }
+          lock.lock();
+        }
+    }
+
+    //! j(0) of a crew that got no thread from the pool, on the thread joining it
+    void run_deferred(crew::impl& c)
+    {
+      //the joining thread is left on the cpus it was on
+      boost::exception_ptr e = work(c, 0, -1, home);
+      boost::mutex::scoped_lock lock(mtx);
+      returned(c, e);
+    }
+
+    //! the cpus of the process when the pool was made
+    const std::vector<unsigned> home;
+    boost::mutex mtx;
+    boost::condition_variable done;
+    std::vector<boost::shared_ptr<slot> > slots;
+    std::vector<unsigned> idle;
+    bool quitting;
+    boost::thread_group threads;
+  };
+
+  thread_pool::thread_pool(unsigned nthread)
+    : impl_(new impl(nthread ? nthread : unsigned(affinity::cpus().size())))
+  { }
+
+  thread_pool::~thread_pool()
+  { }
+
+  namespace
+  {
+    thread_pool* shared_pool = 0;
+
+    void make_shared_pool()
+    {
+      unsigned n = 0;
+      if (const char* env = std::getenv("ECTO_POOL_THREADS"))
+        {
+          try
+            {
+              n = boost::lexical_cast<unsigned>(env);
+            }
+          catch (const boost::bad_lexical_cast&)
+            {
+              ECTO_LOG_DEBUG("ignoring ECTO_POOL_THREADS=%s", env);
+            }
+        }
+      shared_pool = new thread_pool(n);
+    }
+  }
+
+  thread_pool&
+  thread_pool::shared()
+  {
+    static boost::once_flag once = BOOST_ONCE_INIT;
+    boost::call_once(make_shared_pool, once);
+    return *shared_pool;
+  }
+
+  unsigned
+  thread_pool::size() const
+  {
+    boost::mutex::scoped_lock lock(impl_->mtx);
+    return unsigned(impl_->slots.size());
+  }
+
+  unsigned
+  thread_pool::idle() const
+  {
+    boost::mutex::scoped_lock lock(impl_->mtx);
+    return unsigned(impl_->idle.size());
+  }
+
+  thread_pool::crew::crew(thread_pool& pool, unsigned n, const job& j,
+                          const std::vector<int>& cpus)
+    : pool_(pool.impl_)
+    , impl_(new impl(j))
+  {
+    if (n == 0)
+      return;
+    thread_pool::impl& p = *pool_;
+    boost::mutex::scoped_lock lock(p.mtx);
+    //a scheduler may ask for more threads than there are cpus
+    p.grow(n);
+    unsigned k = std::min(n, unsigned(p.idle.size()));
+    for (unsigned i = 0; i < k; ++i)
+      {
+        unsigned s = p.idle.back();
+        p.idle.pop_back();
+        thread_pool::impl::slot& sl = *p.slots[s];
+        sl.borrower = impl_;
+        sl.index = i;
+        sl.cpu = i < cpus.size() ? cpus[i] : -1;
+        impl_->slots.push_back(s);
+        sl.lent.notify_one();
+      }
+    impl_->remaining = std::max(k, 1u);
+    if (k == 0)
+      {
+        //the caller is about to block in join() anyway, it can run the job there.
+        ECTO_LOG_DEBUG("no idle pool thread of %u, deferring the job to join()", p.slots.size());
+        impl_->deferred = true;
+      }
+  }
+
+  thread_pool::crew::~crew()
+  {
+    try
+      {
+        join();
+      }
+    catch (...)
+      {
+        ECTO_LOG_DEBUG("%s", "crew joined with an error, dropped");
+      }
+  }
+
+  unsigned
+  thread_pool::crew::size() const
+  {
+    return std::max(unsigned(impl_->slots.size()), 1u);
+  }
+
+  bool
+  thread_pool::crew::deferred() const
+  {
+    boost::mutex::scoped_lock lock(pool_->mtx);
+    return impl_->deferred;
+  }
+
+  void
+  thread_pool::crew::join()
+  {
+    bool run_here = false;
+    {
+      boost::mutex::scoped_lock lock(pool_->mtx);
+      std::swap(run_here, impl_->deferred);
+    }
+    if (run_here)
+      pool_->run_deferred(*impl_);
+    {
+      boost::mutex::scoped_lock lock(pool_->mtx);
+      while (impl_->remaining != 0)
+        pool_->done.wait(lock);
+    }
+    boost::exception_ptr e;
+    {
+      boost::mutex::scoped_lock lock(pool_->mtx);
+      std::swap(e, impl_->error);
+    }
+    if (e)
+      boost::rethrow_exception(e);
+  }
+
+  void
+  thread_pool::crew::interrupt()
+  {
+    boost::mutex::scoped_lock lock(pool_->mtx);
+    for (std::size_t i = 0; i < impl_->slots.size(); ++i)
+      {
+        thread_pool::impl::slot& sl = *pool_->slots[impl_->slots[i]];
+        if (sl.borrower == impl_)
+          sl.thread->interrupt();
+      }
+  }
+}
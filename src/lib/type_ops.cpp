@@ -0,0 +1,116 @@
+// 
+// Copyright (c) 2011, Willow Garage, Inc.
+// All rights reserved.
+// 
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//     * Neither the name of the Willow Garage, Inc. nor the names of its
+//       contributors may be used to endorse or promote products derived from
+//       this software without specific prior written permission.
+// 
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+// 
+#include <ecto/type_ops.hpp>
+#include <ecto/except.hpp>
+
+#include <boost/thread/mutex.hpp>
+
+#include <map>
+
+namespace ecto
+{
+  namespace types
+  {
+    namespace
+    {
+      //
+      //  ids index a two level table that never moves, so by_id can read it
+      //  without locking while intern appends.  intern publishes chunks and
+      //  entries with store_release, by_id reads them with load_acquire.
+      //
+      enum { CHUNK = 256, N_CHUNKS = 256 };
+
+      typedef type_ops* volatile entry;
+      entry* volatile chunks[N_CHUNKS];
+      std::size_t next_id = 1;
+
+      typedef std::map<std::string, type_ops*> name_map;
+
+      name_map& names()
+      {
+        static name_map m;
+        return m;
+      }
+
+      boost::mutex& mtx()
+      {
+        static boost::mutex m;
+        return m;
+      }
+    }
+
+    type_ops* intern(type_ops& ops)
+    {
+      boost::mutex::scoped_lock lock(mtx());
+      const std::string& name = ops.name();
+      name_map::iterator it = names().find(name);
+      if (it != names().end())
+      {
+        ops.id = it->second->id;
+        return it->second;
+      }
+      std::size_t id = next_id;
+      if (id / CHUNK >= N_CHUNKS)
+        BOOST_THROW_EXCEPTION(except::EctoException()
+                              << except::diag_msg("Too many tendril types")
+                              << except::cpp_typename(name));
+      entry* chunk = chunks[id / CHUNK];
+      if (!chunk)
+      {
+        chunk = new entry[CHUNK]();
+        store_release(chunks[id / CHUNK], chunk);
+      }
+      ops.id = id;
+      store_release(chunk[id % CHUNK], &ops);
+      names()[name] = &ops;
+      ++next_id;
+      return &ops;
+    }
+
+    type_ops* by_id(std::size_t id)
+    {
+      if (id == 0 || id / CHUNK >= N_CHUNKS)
+        return 0;
+      entry* chunk = load_acquire(chunks[id / CHUNK]);
+      return chunk ? load_acquire(chunk[id % CHUNK]) : 0;
+    }
+
+    type_ops* by_name(const std::string& name)
+    {
+      boost::mutex::scoped_lock lock(mtx());
+      name_map::const_iterator it = names().find(name);
+      return it == names().end() ? 0 : it->second;
+    }
+
+    std::size_t end_id()
+    {
+      boost::mutex::scoped_lock lock(mtx());
+      return next_id;
+    }
+  }
+}
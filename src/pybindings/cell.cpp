@@ -53,7 +53,11 @@ namespace ecto
 
     struct cellwrap: cell, bp::wrapper<cell>
     {
-      cellwrap():initialized_(false){}
+      cellwrap()
+        : initialized_(false)
+        , dirty_inputs_(new dirty_list)
+        , dirty_outputs_(new dirty_list)
+      { }
 
       void dispatch_start()
       {
@@ -85,24 +89,21 @@ namespace ecto
 
       void dispatch_configure(const tendrils& params, const tendrils& inputs, const tendrils& outputs)
       {
+        for (tendrils::const_iterator it = inputs.begin(); it != inputs.end(); ++it)
+          dirty_inputs_->watch(it->second);
+        for (tendrils::const_iterator it = outputs.begin(); it != outputs.end(); ++it)
+          dirty_outputs_->watch(it->second);
         ecto::py::scoped_call_back_to_python scb;
         if (bp::override config = this->get_override("configure"))
           config(boost::ref(params));
       }
 
-      struct YouveBeenServed
-      {
-        void operator()(const tendrils::value_type& t)
-        {
-          t.second->notify();
-        }
-      };
-
       ReturnCode dispatch_process(const tendrils& inputs, const tendrils& outputs)
       {
         ecto::py::scoped_call_back_to_python scb;
         int value = OK;
-        std::for_each(inputs.begin(),inputs.end(), YouveBeenServed());
+        if (!dirty_inputs_->empty())
+          dirty_inputs_->notify();
         if (bp::override proc = this->get_override("process"))
           {
             bp::object rval = proc(boost::ref(inputs), boost::ref(outputs));
@@ -111,7 +112,8 @@ namespace ecto
               value = x();
             }
           }
-        std::for_each(outputs.begin(),outputs.end(),YouveBeenServed());
+        if (!dirty_outputs_->empty())
+          dirty_outputs_->notify();
         return ReturnCode(value);
       }
 
@@ -150,6 +152,8 @@ namespace ecto
         return cell_ptr();
       }
       bool initialized_;
+      //! inputs and outputs python has set, whose callbacks are due
+      dirty_list_ptr dirty_inputs_, dirty_outputs_;
     };
 
     const tendrils& inputs(cell& mod)
@@ -176,6 +180,10 @@ namespace ecto
       bp::class_<cellwrap, boost::shared_ptr<cellwrap>, boost::noncopyable> ("_cell_base" /*bp::no_init*/)
         .def("_set_strand", &cell::set_strand)
         .def("_reset_strand", &cell::reset_strand)
+        .add_property("priority",
+                      (int(cell::*)() const) &cell::priority,
+                      (void(cell::*)(int)) &cell::priority,
+                      "Of the cells ready at once, higher priority ones run first.")
         .def("construct", &inspect_impl)
         .def("declare_params", &cell::declare_params)
         .def("declare_io", ((void(cell::*)()) &cell::declare_io))
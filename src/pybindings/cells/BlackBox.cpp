@@ -86,6 +86,14 @@ namespace ecto
         }
         return ecto::OK;
       }
+
+      //! the inner plasm, if it runs once per tick and may be flattened into the outer one
+      plasm::ptr
+      subgraph() const
+      {
+        return niter_ == 1 ? plasm_ : plasm::ptr();
+      }
+
       plasm::ptr plasm_;
       boost::shared_ptr<scheduler_t> sched_;
       int niter_;
@@ -99,6 +99,26 @@ namespace ecto
       p.connect(fc, fromport, tc, toport);
     }
 
+    void plasm_connect_bounded(plasm& p,
+                               bp::object fromcell, std::string fromport,
+                               bp::object tocell, std::string toport,
+                               std::size_t capacity, graph::edge::overflow_policy policy)
+    {
+      bp::object fc_impl = getattr(fromcell, "__impl");
+      cell::ptr fc = bp::extract<cell::ptr>(fc_impl);
+      bp::object tc_impl = getattr(tocell, "__impl");
+      cell::ptr tc = bp::extract<cell::ptr>(tc_impl);
+      p.connect(fc, fromport, tc, toport, capacity, policy);
+    }
+
+    void plasm_connect_bounded_block(plasm& p,
+                                     bp::object fromcell, std::string fromport,
+                                     bp::object tocell, std::string toport,
+                                     std::size_t capacity)
+    {
+      plasm_connect_bounded(p, fromcell, fromport, tocell, toport, capacity, graph::edge::BLOCK);
+    }
+
     void plasm_disconnect_explicit(plasm& p,
                                    bp::object fromcell, std::string fromport,
                                    bp::object tocell, std::string toport)
@@ -111,7 +131,8 @@ namespace ecto
     }
 
 
-    void plasm_connect_list(plasm& p, bp::list connections)
+    void plasm_connect_list_bounded(plasm& p, bp::list connections,
+                                    std::size_t capacity, graph::edge::overflow_policy policy)
     {
       connections = sanitize_connection_list(connections);
       bp::stl_input_iterator<bp::tuple> begin(connections), end;
@@ -121,14 +142,22 @@ namespace ecto
         cell::ptr from = bp::extract<cell::ptr>(x[0]);
         cell::ptr to = bp::extract<cell::ptr>(x[2]);
         std::string output = bp::extract<std::string>(x[1]), input = bp::extract<std::string>(x[3]);
-        p.connect(from, output, to, input);
+        p.connect(from, output, to, input, capacity, policy);
       }
     }
 
+    void plasm_connect_list(plasm& p, bp::list connections)
+    {
+      plasm_connect_list_bounded(p, connections, 0, graph::edge::BLOCK);
+    }
+
     int plasm_connect_args(boost::python::tuple args, bp::dict kw)
     {
       int i = 0;
       plasm::ptr p = bp::extract<plasm::ptr>(args[i++]);
+      std::size_t capacity = bp::extract<std::size_t>(kw.get("capacity", 0));
+      graph::edge::overflow_policy policy =
+        bp::extract<graph::edge::overflow_policy>(kw.get("overflow", graph::edge::BLOCK));
       for (int end = bp::len(args); i < end; i++)
       {
         bp::list l;
@@ -141,7 +170,7 @@ namespace ecto
           throw std::runtime_error(
               "Did you mean plasm.connect(cellA['out'] >> cellB['in']), or plasm.connect(cellA,'out',cellB,'in')?");
               }
-        plasm_connect_list(*p, l);
+        plasm_connect_list_bounded(*p, l, capacity, policy);
       }
       return i;
     }
@@ -207,10 +236,59 @@ namespace ecto
       p.insert(c);
     }
 
+    graph::edge::queue_type plasm_get_edge_queue(plasm& p)
+    {
+      return p.edge_queue();
+    }
+
+    void plasm_set_edge_queue(plasm& p, graph::edge::queue_type q)
+    {
+      p.edge_queue(q);
+    }
+
+    double plasm_get_deadline(plasm& p)
+    {
+      return p.deadline().total_microseconds() / 1e+06;
+    }
+
+    void plasm_set_deadline(plasm& p, double seconds)
+    {
+      p.deadline(boost::posix_time::microseconds(boost::int64_t(seconds * 1e+06)));
+    }
+
+    bp::list plasm_edge_stats(plasm& p)
+    {
+      bp::list result;
+      const ecto::graph::graph_t& g = p.graph();
+      ecto::graph::graph_t::edge_iterator begin, end;
+      for (boost::tie(begin, end) = boost::edges(g); begin != end; ++begin)
+      {
+        cell::ptr to = g[boost::target(*begin, g)], from = g[boost::source(*begin, g)];
+        graph::edge_ptr e = g[*begin];
+        double blocked = e->blocked_time().total_microseconds() / 1e+06;
+        result.append(bp::make_tuple(bp::make_tuple(from, e->from_port(), to, e->to_port()),
+                                     e->capacity(), e->dropped(), blocked));
+      }
+      return result;
+    }
+
     void wrap()
     {
       using bp::arg;
 
+      bp::enum_<graph::edge::queue_type>("EdgeQueue")
+        .value("DEQUE", graph::edge::DEQUE)
+        .value("RINGBUFFER", graph::edge::RINGBUFFER)
+        .export_values()
+        ;
+
+      bp::enum_<graph::edge::overflow_policy>("Overflow")
+        .value("BLOCK", graph::edge::BLOCK)
+        .value("DROP_OLDEST", graph::edge::DROP_OLDEST)
+        .value("DROP_NEWEST", graph::edge::DROP_NEWEST)
+        .export_values()
+        ;
+
       bp::class_<plasm, boost::shared_ptr<plasm>, boost::noncopyable> p("Plasm");
       p.def("insert", &plasm_insert, bp::args("cell"), "insert a black box into the graph");
       p.def("insert", &plasm::insert, bp::args("cell"), "insert cell into the graph");//order is important here.
@@ -219,6 +297,13 @@ namespace ecto
       p.def("connect", bp::raw_function(plasm_connect_args, 2));
       p.def("connect", &plasm_connect_explicit,
             bp::args("from_cell", "output_name", "to_cell", "intput_name"));
+      p.def("connect", &plasm_connect_bounded_block,
+            bp::args("from_cell", "output_name", "to_cell", "intput_name", "capacity"));
+      p.def("connect", &plasm_connect_bounded,
+            bp::args("from_cell", "output_name", "to_cell", "intput_name", "capacity", "overflow"),
+            "Connect with an edge that buffers at most capacity values, 0 is unbounded. "
+            "overflow is one of ecto.Overflow.BLOCK, DROP_OLDEST or DROP_NEWEST. The capacity "
+            "and overflow keywords are also accepted by plasm.connect(a['out'] >> b['in'], ...).");
       p.def("disconnect", &plasm_disconnect_explicit,
             bp::args("from_cell", "output_name", "to_cell", "intput_name"));
       p.def("execute", &plasm_execute,
@@ -228,9 +313,20 @@ namespace ecto
       p.def("viz", wrapViz, "Get a graphviz string representation of the plasm.");
       p.def("connections", plasm_get_connections, "Grabs the current list based description of the graph. "
             "Its a list of tuples (from_cell, output_key, to_cell, input_key)");
+      p.def("edge_stats", plasm_edge_stats, "A list of ((from_cell, output_key, to_cell, input_key), "
+            "capacity, dropped, blocked_seconds) for each edge, the counters of the overflow policy.");
       p.def("cells", plasm_get_cells, "Grabs the current set of cells that are in the plasm.");
       p.def("check", &plasm::check);
+      p.def("flatten", &plasm::flatten,
+            "Splice the cells of each BlackBox run once per tick into the plasm in its place, "
+            "so the outer scheduler runs them like any other. Returns how many were replaced.");
       p.def("configure_all", &plasm::configure_all);
+      p.add_property("edge_queue", plasm_get_edge_queue, plasm_set_edge_queue,
+                     "The queue used to buffer values on the edges of the graph, "
+                     "ecto.EdgeQueue.DEQUE or ecto.EdgeQueue.RINGBUFFER.");
+      p.add_property("deadline", plasm_get_deadline, plasm_set_deadline,
+                     "Seconds each tick has from its sources to its sinks, 0 for none. "
+                     "Schedulers that order their work run the most urgent first.");
       p.def("save",plasm_save);
       p.def("load",plasm_load);
 
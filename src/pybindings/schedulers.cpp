@@ -27,6 +27,11 @@
 // 
 #include <ecto/schedulers/singlethreaded.hpp>
 #include <ecto/schedulers/multithreaded.hpp>
+#include <ecto/schedulers/dataflow.hpp>
+#include <ecto/schedulers/sdf.hpp>
+#include <ecto/schedulers/pipelined.hpp>
+#include <ecto/affinity.hpp>
+#include <ecto/thread_pool.hpp>
 
 namespace bp = boost::python;
 
@@ -44,11 +49,93 @@ namespace ecto {
       return s.execute_async(arg1, arg2); 
     }
 
+    template <typename T>
+    bp::list to_list(const std::vector<T>& v)
+    {
+      bp::list l;
+      for (std::size_t j = 0; j < v.size(); ++j)
+        l.append(v[j]);
+      return l;
+    }
+
+    bp::list get_cpus(const scheduler& s)
+    {
+      return to_list(s.cpus());
+    }
+
+    void set_cpus(scheduler& s, bp::object cpus)
+    {
+      std::vector<unsigned> c;
+      for (unsigned j = 0; j < bp::len(cpus); ++j)
+        c.push_back(bp::extract<unsigned>(cpus[j]));
+      s.cpus(c);
+    }
+
+    void set_numa_node(scheduler& s, bp::object c, int node)
+    {
+      s.numa_node(bp::extract<cell::ptr>(getattr(c, "__impl")), node);
+    }
+
+    bp::list placement(const scheduler& s)
+    {
+      return to_list(s.placement());
+    }
+
+    bp::list physical_cores()
+    {
+      return to_list(affinity::physical_cores());
+    }
+
+    unsigned pool_threads()
+    {
+      return thread_pool::shared().size();
+    }
+
+    unsigned pool_idle()
+    {
+      return thread_pool::shared().idle();
+    }
+
+    std::size_t sdf_repetitions(schedulers::sdf& s, bp::object c)
+    {
+      return s.repetitions(bp::extract<cell::ptr>(getattr(c, "__impl")));
+    }
+
+    std::size_t sdf_buffer(schedulers::sdf& s, bp::object c, const std::string& input)
+    {
+      return s.buffer(bp::extract<cell::ptr>(getattr(c, "__impl")), input);
+    }
+
+    void pipelined_set_stages(schedulers::pipelined& s, bp::object stages)
+    {
+      s.clear_stages();
+      for (unsigned k = 0; k < bp::len(stages); ++k)
+      {
+        bp::object stage = stages[k];
+        for (unsigned j = 0; j < bp::len(stage); ++j)
+          s.stage(bp::extract<cell::ptr>(getattr(stage[j], "__impl")), k);
+      }
+    }
+
+    bp::list pipelined_layout(const schedulers::pipelined& s)
+    {
+      std::vector<std::vector<cell::ptr> > layout = s.layout();
+      bp::list l;
+      for (std::size_t k = 0; k < layout.size(); ++k)
+      {
+        bp::list stage;
+        for (std::size_t j = 0; j < layout[k].size(); ++j)
+          stage.append(layout[k][j]->name());
+        l.append(stage);
+      }
+      return l;
+    }
+
     template <typename T> 
-    void wrap_scheduler(const char* name)
+    bp::class_<T, boost::noncopyable> wrap_scheduler(const char* name)
     {
       using bp::arg;
-      bp::class_<T, boost::noncopyable>(name, bp::init<ecto::plasm::ptr>())
+      return bp::class_<T, boost::noncopyable>(name, bp::init<ecto::plasm::ptr>())
         .def("execute", &execute0<T>)
         .def("execute", &execute1<T>, arg("niter"))
         .def("execute", &execute2<T>, (arg("niter"), arg("nthreads")))
@@ -62,6 +149,16 @@ namespace ecto {
         .def("running", (bool (scheduler::*)() const) &scheduler::running)
         .def("wait", &T::wait)
         .def("stats", &T::stats)
+        .add_property("batch",
+                      (unsigned (scheduler::*)() const) &scheduler::batch,
+                      (void (scheduler::*)(unsigned)) &scheduler::batch)
+        .add_property("cpus", &get_cpus, &set_cpus)
+        .def("one_per_core", &T::one_per_core,
+             "Pin workers to one cpu per physical core.")
+        .def("numa_node", &set_numa_node, (arg("cell"), arg("node")),
+             "Keep the cell and the buffers of its edges on a NUMA node, -1 unbinds it.")
+        .def("placement", &placement,
+             "The cpu each worker of the last run was pinned to, -1 where it wasn't.")
         ;
     }
 
@@ -77,9 +174,43 @@ namespace ecto {
 
       //      wrap_scheduler<singlethreaded>("Singlethreaded");
 
+      bp::def("physical_cores", &physical_cores,
+              "One logical cpu of each physical core the process may run on.");
+      bp::def("node_of", &affinity::node_of, arg("cpu"), "The NUMA node of a cpu.");
+      bp::def("pool_threads", &pool_threads,
+              "Threads of the pool Multithreaded and Dataflow borrow their workers from.");
+      bp::def("pool_idle", &pool_idle, "Threads of the pool not lent at the moment.");
+
       wrap_scheduler<singlethreaded>("Singlethreaded");
 
       wrap_scheduler<multithreaded>("Multithreaded");
+
+      wrap_scheduler<dataflow>("Dataflow")
+        .add_property("ticks_in_flight",
+                      (unsigned (dataflow::*)() const) &dataflow::ticks_in_flight,
+                      (void (dataflow::*)(unsigned)) &dataflow::ticks_in_flight)
+        ;
+
+      wrap_scheduler<sdf>("Sdf")
+        .def("repetitions", &sdf_repetitions, arg("cell"),
+             "How many times the cell fires per period, 0 until the schedule is computed.")
+        .def("buffer", &sdf_buffer, (arg("cell"), arg("input")),
+             "The most values the schedule holds on the edge into the cell's input.")
+        ;
+
+      wrap_scheduler<pipelined>("Pipelined")
+        .add_property("nstages",
+                      (unsigned (pipelined::*)() const) &pipelined::nstages,
+                      (void (pipelined::*)(unsigned)) &pipelined::nstages)
+        .add_property("max_in_flight",
+                      (unsigned (pipelined::*)() const) &pipelined::max_in_flight,
+                      (void (pipelined::*)(unsigned)) &pipelined::max_in_flight)
+        .def("set_stages", &pipelined_set_stages, arg("stages"),
+             "Place cells by hand, a list of lists of cells, one per stage.")
+        .def("clear_stages", &pipelined::clear_stages)
+        .def("layout", &pipelined_layout,
+             "The names of the cells in each stage of the last run.")
+        ;
         
     }
   }
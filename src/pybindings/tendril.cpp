@@ -101,6 +101,36 @@ bool tendril_required(tendril_ptr t)
   return t->required();
 }
 
+bool tendril_shared_payload(tendril_ptr t)
+{
+  return t->shared_payload();
+}
+
+void tendril_set_shared_payload(tendril_ptr t, bool b)
+{
+  t->shared_payload(b);
+}
+
+bool tendril_rewritten(tendril_ptr t)
+{
+  return t->rewritten();
+}
+
+void tendril_set_rewritten(tendril_ptr t, bool b)
+{
+  t->rewritten(b);
+}
+
+unsigned tendril_rate(tendril_ptr t)
+{
+  return t->rate();
+}
+
+void tendril_set_rate(tendril_ptr t, unsigned r)
+{
+  t->rate(r);
+}
+
 void wrapConnection(){
   bp::class_<tendril,boost::shared_ptr<tendril> > Tendril_("Tendril", 
       "The Tendril is the slendor winding organ of ecto.\n"
@@ -117,6 +147,12 @@ void wrapConnection(){
         "Remember that the implicit default is always the default constructed type.");
     Tendril_.add_property("required",tendril_required, "Is this tendril required to be connected?");
     Tendril_.add_property("dirty",tendril_dirty, "Has the tendril changed since the last time?");
+    Tendril_.add_property("shared_payload",tendril_shared_payload, tendril_set_shared_payload,
+        "Hand this output's value to its consumers as a shared, copy on write payload instead of copying it.");
+    Tendril_.add_property("rewritten",tendril_rewritten, tendril_set_rewritten,
+        "Does the cell assign this output in full every process? If so a single consumer may take the value without a copy.");
+    Tendril_.add_property("rate",tendril_rate, tendril_set_rate,
+        "How many values the port produces or consumes each time its cell fires, honoured by the Sdf scheduler.");
     Tendril_.def("get",tendril_get_val, "Gets the python value of the object.\n"
     "May be None if python bindings for the type held do not have boost::python bindings available from the current scope."
     );
@@ -29,6 +29,7 @@
 import ecto
 import ecto_test
 import sys
+import time
 
 def build_addergraph(nlevels):
     
@@ -79,20 +80,33 @@ def test_plasm_impl(sched_type, nlevels, nthreads, niter):
     (plasm, outnode) = build_addergraph(nlevels)
     print "*"*80, "\nSCHED:", sched_type
     sched = sched_type(plasm)
+    start = time.time()
     sched.execute(niter, nthreads)
+    elapsed = time.time() - start
     print sched.stats()
+    print "THREADS:", nthreads, "ELAPSED:", elapsed
     print "RESULT:", outnode.outputs.out
     shouldbe = float(2**nlevels * niter)
     print "expected:", shouldbe
     assert outnode.outputs.out == shouldbe
 
 def test_plasm(nlevels, nthreads, niter):
-    for sched in [ecto.schedulers.Singlethreaded, ecto.schedulers.Threadpool]:
+    for sched in [ecto.schedulers.Singlethreaded, ecto.schedulers.Threadpool,
+                  ecto.schedulers.Dataflow]:
         test_plasm_impl(sched, nlevels, nthreads, niter)
 
+def test_scaling(nlevels, niter):
+    # independent adders of one tick run side by side, so this
+    # should get close to linear in the number of cores.
+    n = 1
+    while n <= ecto.hardware_concurrency():
+        test_plasm_impl(ecto.schedulers.Dataflow, nlevels, n, niter)
+        n *= 2
+
 if __name__ == '__main__':
     #test_plasm(9, 4, 10000)
     test_plasm(10, 8, 10000)
+    test_scaling(10, 1000)
     #test_plasm(9, 12, 10000)
     #test_plasm(6, 6, 6000)
     #test_plasm(8, 1, 5)
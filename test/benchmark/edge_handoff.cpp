@@ -0,0 +1,68 @@
+//
+// Copyright (c) 2011, Willow Garage, Inc.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//     * Neither the name of the Willow Garage, Inc. nor the names of its
+//       contributors may be used to endorse or promote products derived from
+//       this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+#include <ecto/ecto.hpp>
+#include <ecto/edge.hpp>
+
+#include <boost/date_time/posix_time/posix_time.hpp>
+
+#include <iostream>
+
+using ecto::tendril;
+using ecto::graph::edge;
+
+namespace
+{
+  //! average cost of one push_back/front/pop_front handoff through the edge
+  double handoff_ns(edge::queue_type q, unsigned n)
+  {
+    edge e("out", "in", q);
+    tendril from(0.0, "a doc string"), to(0.0, "");
+    boost::posix_time::ptime start = boost::posix_time::microsec_clock::universal_time();
+    for (unsigned j = 0; j < n; ++j)
+    {
+      e.push_back(from);
+      to << e.front();
+      e.pop_front();
+    }
+    boost::posix_time::time_duration elapsed = boost::posix_time::microsec_clock::universal_time() - start;
+    return elapsed.total_microseconds() * 1000.0 / n;
+  }
+}
+
+int main()
+{
+  const unsigned n = 1000000;
+  // warm up
+  handoff_ns(edge::DEQUE, n / 10);
+  handoff_ns(edge::RINGBUFFER, n / 10);
+  double deque_ns = handoff_ns(edge::DEQUE, n);
+  double ring_ns = handoff_ns(edge::RINGBUFFER, n);
+  std::cout << "edge handoff, deque:      " << deque_ns << " ns\n"
+            << "edge handoff, ringbuffer: " << ring_ns << " ns" << std::endl;
+  return 0;
+}
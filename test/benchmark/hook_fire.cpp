@@ -0,0 +1,56 @@
+//
+// Copyright (c) 2011, Willow Garage, Inc.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//     * Neither the name of the Willow Garage, Inc. nor the names of its
+//       contributors may be used to endorse or promote products derived from
+//       this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+#include <ecto/hook.hpp>
+
+#include <boost/date_time/posix_time/posix_time.hpp>
+#define BOOST_SIGNALS2_MAX_ARGS 3
+#include <boost/signals2.hpp>
+
+#include <iostream>
+
+int main()
+{
+  // the cost of firing with nothing connected, what most tendrils do every tick
+  const unsigned n = 10000000;
+  int x = 0;
+  boost::signals2::signal<void(int&, int)> sig;
+  boost::posix_time::ptime start = boost::posix_time::microsec_clock::universal_time();
+  for (unsigned j = 0; j < n; ++j)
+    sig(x, 1);
+  boost::posix_time::time_duration sig_elapsed = boost::posix_time::microsec_clock::universal_time() - start;
+
+  ecto::hook<void(int&, int)> h;
+  start = boost::posix_time::microsec_clock::universal_time();
+  for (unsigned j = 0; j < n; ++j)
+    h(x, 1);
+  boost::posix_time::time_duration hook_elapsed = boost::posix_time::microsec_clock::universal_time() - start;
+
+  std::cout << "empty signals2 emission: " << sig_elapsed.total_microseconds() * 1000.0 / n << " ns, "
+            << "empty hook: " << hook_elapsed.total_microseconds() * 1000.0 / n << " ns" << std::endl;
+  return x;
+}
@@ -0,0 +1,105 @@
+//
+// Copyright (c) 2011, Willow Garage, Inc.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//     * Neither the name of the Willow Garage, Inc. nor the names of its
+//       contributors may be used to endorse or promote products derived from
+//       this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+#include <ecto/ecto.hpp>
+
+#include <boost/any.hpp>
+#include <boost/date_time/posix_time/posix_time.hpp>
+
+#include <iostream>
+#include <string>
+
+using ecto::tendril;
+
+namespace
+{
+  namespace pt = boost::posix_time;
+
+  struct small_struct
+  {
+    double x, y, z;
+  };
+
+  double ns_per(pt::ptime start, unsigned n)
+  {
+    return (pt::microsec_clock::universal_time() - start).total_microseconds() * 1000.0 / n;
+  }
+
+  //! the gets store what they return here, so that they aren't optimized away
+  const volatile void* volatile sink;
+
+  // what tendril::operator<< and get<T> cost on boost::any
+  template<typename T>
+  void any_copy_get(const T& v, unsigned n, double& copy_ns, double& get_ns)
+  {
+    boost::any from(v), to;
+    pt::ptime start = pt::microsec_clock::universal_time();
+    for (unsigned j = 0; j < n; ++j)
+      to = from;
+    copy_ns = ns_per(start, n);
+    start = pt::microsec_clock::universal_time();
+    for (unsigned j = 0; j < n; ++j)
+      sink = boost::any_cast<T>(&to);
+    get_ns = ns_per(start, n);
+  }
+
+  template<typename T>
+  void tendril_copy_get(const T& v, unsigned n, double& copy_ns, double& get_ns)
+  {
+    tendril from(v, "a doc string"), to(v, "");
+    pt::ptime start = pt::microsec_clock::universal_time();
+    for (unsigned j = 0; j < n; ++j)
+      to << from;
+    copy_ns = ns_per(start, n);
+    start = pt::microsec_clock::universal_time();
+    for (unsigned j = 0; j < n; ++j)
+      sink = &to.get<T>();
+    get_ns = ns_per(start, n);
+  }
+
+  template<typename T>
+  void bench(const char* name, const T& v)
+  {
+    const unsigned n = 1000000;
+    double any_copy, any_get, t_copy, t_get;
+    any_copy_get(v, n, any_copy, any_get);
+    tendril_copy_get(v, n, t_copy, t_get);
+    std::cout << name << "\tboost::any copy " << any_copy << " ns, get " << any_get << " ns"
+              << "\ttendril << " << t_copy << " ns, get " << t_get << " ns" << std::endl;
+  }
+}
+
+int main()
+{
+  small_struct s = { 1, 2, 3 };
+  bench("int", 1);
+  bench("double", 1.0);
+  bench("small_struct", s);
+  bench("shared_ptr", boost::shared_ptr<int>(new int(1)));
+  bench("std::string", std::string("a string too long for any small string optimization"));
+  return sink ? 0 : 1;
+}
@@ -0,0 +1,111 @@
+/*
+ * Copyright (c) 2011, Willow Garage, Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the Willow Garage, Inc. nor the names of its
+ *       contributors may be used to endorse or promote products derived from
+ *       this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <ecto/ecto.hpp>
+#include <ecto/registry.hpp>
+#include <boost/asio.hpp>
+#include <boost/bind.hpp>
+#include <boost/date_time/posix_time/posix_time.hpp>
+#include <boost/scoped_ptr.hpp>
+
+#include <stdexcept>
+
+using ecto::tendrils;
+namespace ecto_test
+{
+  struct AsyncSleep
+  {
+    static void declare_params(tendrils& parameters)
+    {
+      parameters.declare<double>("seconds", "wait on a timer this many seconds", 0.01);
+      parameters.declare<int>("fail_at", "fail the tick of this index, if not negative", -1);
+    }
+
+    static void declare_io(const tendrils& parameters, tendrils& inputs, tendrils& outputs)
+    {
+      inputs.declare<double>("in", "input");
+      outputs.declare<double>("out", "output, the input once the timer fires");
+    }
+
+    AsyncSleep() : current(0) { }
+
+    void configure(const tendrils& parameters, const tendrils& inputs, const tendrils& outputs)
+    {
+      seconds = parameters["seconds"];
+      fail_at = parameters["fail_at"];
+      in = inputs["in"];
+      out = outputs["out"];
+    }
+
+    void start() { current = 0; }
+
+    int process_async(const tendrils&, const tendrils&, const ecto::completion& c)
+    {
+      //the scheduler may hand out a different io_service on each execute
+      if (!timer || &timer->get_io_service() != &c.service())
+        timer.reset(new boost::asio::deadline_timer(c.service()));
+      timer->expires_from_now(boost::posix_time::microseconds(int64_t(*seconds * 1.0e6)));
+      timer->async_wait(boost::bind(&AsyncSleep::fired, this, c, *in, current++,
+                                    boost::asio::placeholders::error));
+      return ecto::OK;
+    }
+
+    void fired(const ecto::completion& c, double value, int tick,
+               const boost::system::error_code& ec)
+    {
+      if (ec)
+        {
+          c(ecto::QUIT);
+          return;
+        }
+      if (tick == *fail_at)
+        {
+          try
+            {
+              throw std::runtime_error("AsyncSleep failed");
+            }
+          catch (...)
+            {
+              c.fail(boost::current_exception());
+            }
+          return;
+        }
+      *out = value;
+      c(ecto::OK);
+    }
+
+    ecto::spore<double> seconds;
+    ecto::spore<int> fail_at;
+    ecto::spore<double> in, out;
+    boost::scoped_ptr<boost::asio::deadline_timer> timer;
+    int current;
+  };
+}
+
+ECTO_CELL(ecto_test, ecto_test::AsyncSleep, "AsyncSleep", "Wait on a timer in process_async, then pass the input along");
@@ -0,0 +1,308 @@
+//
+// Copyright (c) 2011, Willow Garage, Inc.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//     * Neither the name of the Willow Garage, Inc. nor the names of its
+//       contributors may be used to endorse or promote products derived from
+//       this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+#include <gtest/gtest.h>
+#include <ecto/ecto.hpp>
+#include <ecto/plasm.hpp>
+#include <ecto/completion.hpp>
+#include <ecto/schedulers/dataflow.hpp>
+#include <ecto/schedulers/singlethreaded.hpp>
+#include <ecto/thread_pool.hpp>
+
+#include <boost/asio.hpp>
+#include <boost/bind.hpp>
+#include <boost/scoped_ptr.hpp>
+#include <boost/thread.hpp>
+
+#include "fixtures.hpp"
+
+#include <stdexcept>
+#include <vector>
+
+using namespace ecto;
+using namespace ecto_test_fixtures;
+namespace {
+  //! passes its input along once a timer fires, failing the tick fail_at
+  struct Delay
+  {
+    static void declare_io(const tendrils& p, tendrils& i, tendrils& o)
+    {
+      i.declare(&Delay::in_, "in");
+      o.declare(&Delay::out_, "out");
+    }
+    Delay() : fail_at(0), quit_at(0), parked(false) { }
+    int process_async(const tendrils&, const tendrils&, const completion& c)
+    {
+      if (*in_ == quit_at)
+        return ecto::QUIT;
+      parked = true;
+      if (!timer || &timer->get_io_service() != &c.service())
+        timer.reset(new boost::asio::deadline_timer(c.service()));
+      timer->expires_from_now(boost::posix_time::milliseconds(2));
+      timer->async_wait(boost::bind(&Delay::fired, this, c, *in_));
+      return ecto::OK;
+    }
+    void fired(const completion& c, int value)
+    {
+      parked = false;
+      if (value == fail_at)
+        {
+          try
+            {
+              throw std::runtime_error("delay failed");
+            }
+          catch (...)
+            {
+              c.fail(boost::current_exception());
+            }
+          return;
+        }
+      *out_ = value;
+      c(ecto::OK);
+    }
+    spore<int> in_, out_;
+    boost::scoped_ptr<boost::asio::deadline_timer> timer;
+    int fail_at, quit_at;
+    volatile bool parked;
+  };
+
+  //! an async cell whose work is done before process_async returns
+  struct Immediate
+  {
+    static void declare_io(const tendrils& p, tendrils& i, tendrils& o)
+    {
+      i.declare(&Immediate::in_, "in");
+      o.declare(&Immediate::out_, "out");
+    }
+    int process_async(const tendrils&, const tendrils&, const completion& c)
+    {
+      *out_ = *in_;
+      c(ecto::OK);
+      return ecto::OK;
+    }
+    spore<int> in_, out_;
+  };
+
+  //! passes its input along from a thread of its own, a while after
+  //! process_async returned, with nothing pending on the io_service
+  struct Late
+  {
+    static void declare_io(const tendrils& p, tendrils& i, tendrils& o)
+    {
+      i.declare(&Late::in_, "in");
+      o.declare(&Late::out_, "out");
+    }
+    ~Late()
+    {
+      if (worker.joinable())
+        worker.join();
+    }
+    int process_async(const tendrils&, const tendrils&, const completion& c)
+    {
+      //the previous tick's completion has been called, its thread is done
+      if (worker.joinable())
+        worker.join();
+      worker = boost::thread(boost::bind(&Late::fire, this, c, int(*in_)));
+      return ecto::OK;
+    }
+    void fire(const completion& c, int value)
+    {
+      boost::this_thread::sleep(boost::posix_time::milliseconds(2));
+      *out_ = value;
+      c(ecto::OK);
+    }
+    spore<int> in_, out_;
+    boost::thread worker;
+  };
+
+  //! runs a dataflow scheduler over p in one thread of the shared pool
+  //! while the others wait, so the scheduler's crew gets no thread
+  struct Starved
+  {
+    Starved(plasm::ptr p_, unsigned niter_)
+      : p(p_), niter(niter_), idle(0), rval(-1), done(false)
+    { }
+    void operator()(unsigned j)
+    {
+      if (j != 0)
+        {
+          boost::mutex::scoped_lock lock(mtx);
+          while (!done)
+            cond.wait(lock);
+          return;
+        }
+      idle = thread_pool::shared().idle();
+      schedulers::dataflow sched(p);
+      rval = sched.execute(niter, 1);
+      boost::mutex::scoped_lock lock(mtx);
+      done = true;
+      cond.notify_all();
+    }
+    plasm::ptr p;
+    unsigned niter, idle;
+    int rval;
+    bool done;
+    boost::mutex mtx;
+    boost::condition_variable cond;
+  };
+
+  //! counts its ticks that ran while the Delay it watches was parked
+  struct Watch
+  {
+    static void declare_io(const tendrils& p, tendrils& i, tendrils& o)
+    {
+    }
+    Watch() : watched(0), ticks(0), overlaps(0) { }
+    int process(const tendrils&, const tendrils&)
+    {
+      ++ticks;
+      if (watched->parked)
+        ++overlaps;
+      return ecto::OK;
+    }
+    const Delay* watched;
+    unsigned ticks, overlaps;
+  };
+
+  typedef chain<Delay> delaying;
+
+  //! the sink saw 1, 2, .. n in order
+  void expect_passed(const delaying& c, unsigned n)
+  {
+    const std::vector<int>& seen = c.seen();
+    ASSERT_EQ(n, seen.size());
+    for (unsigned j = 0; j < n; ++j)
+      EXPECT_EQ(int(j + 1), seen[j]);
+  }
+
+  int finish_now(const completion& c, int rval)
+  {
+    c(rval);
+    c(ecto::OK); //ignored
+    return ecto::OK;
+  }
+}
+
+TEST(Async, Detected)
+{
+  EXPECT_TRUE(make<Delay>()->async());
+  EXPECT_FALSE(make<Count>()->async());
+}
+
+TEST(Async, WaitFor)
+{
+  EXPECT_EQ(ecto::QUIT, wait_for(boost::bind(finish_now, _1, int(ecto::QUIT))));
+  EXPECT_EQ(ecto::OK, wait_for(boost::bind(finish_now, _1, int(ecto::OK))));
+}
+
+TEST(Async, Dataflow)
+{
+  delaying c;
+  schedulers::dataflow sched(c.p);
+  sched.execute(20, 2);
+  expect_passed(c, 20);
+  sched.execute(5, 2);
+  EXPECT_EQ(25u, c.seen().size());
+}
+
+TEST(Async, QuitDataflow)
+{
+  delaying c;
+  impl<Delay>(c.mid).quit_at = 3;
+  schedulers::dataflow sched(c.p);
+  EXPECT_EQ(ecto::QUIT, sched.execute(10, 2));
+  EXPECT_GE(2u, c.seen().size());
+}
+
+TEST(Async, CompletedInlineDataflow)
+{
+  chain<Immediate> c;
+  schedulers::dataflow sched(c.p);
+  sched.execute(20, 2);
+  const std::vector<int>& seen = c.seen();
+  ASSERT_EQ(20u, seen.size());
+  for (unsigned j = 0; j < 20; ++j)
+    EXPECT_EQ(int(j + 1), seen[j]);
+}
+
+TEST(Async, LateCompletionNoPoolThread)
+{
+  chain<Late> c;
+  Starved run(c.p, 10);
+  thread_pool& pool = thread_pool::shared();
+  {
+    thread_pool::crew crew(pool, pool.size(), boost::ref(run));
+    crew.join();
+  }
+  EXPECT_EQ(0u, run.idle);
+  EXPECT_EQ(ecto::OK, run.rval);
+  const std::vector<int>& seen = c.seen();
+  ASSERT_EQ(10u, seen.size());
+  for (unsigned j = 0; j < 10; ++j)
+    EXPECT_EQ(int(j + 1), seen[j]);
+}
+
+TEST(Async, StrandHeldWhileParked)
+{
+  delaying c;
+  cell_ptr watch = make<Watch>();
+  impl<Watch>(watch).watched = &impl<Delay>(c.mid);
+  ecto::strand s;
+  c.mid->set_strand(s);
+  watch->set_strand(s);
+  c.p->insert(watch);
+  schedulers::dataflow sched(c.p);
+  sched.execute(20, 4);
+  expect_passed(c, 20);
+  EXPECT_EQ(20u, impl<Watch>(watch).ticks);
+  EXPECT_EQ(0u, impl<Watch>(watch).overlaps);
+}
+
+TEST(Async, Singlethreaded)
+{
+  delaying c;
+  schedulers::singlethreaded sched(c.p);
+  sched.execute(10);
+  expect_passed(c, 10);
+}
+
+TEST(Async, FailDataflow)
+{
+  delaying c;
+  impl<Delay>(c.mid).fail_at = 3;
+  schedulers::dataflow sched(c.p);
+  EXPECT_THROW(sched.execute(10, 2), except::CellException);
+  EXPECT_GE(2u, c.seen().size());
+}
+
+TEST(Async, FailSinglethreaded)
+{
+  delaying c;
+  impl<Delay>(c.mid).fail_at = 3;
+  schedulers::singlethreaded sched(c.p);
+  EXPECT_THROW(sched.execute(10), except::CellException);
+}
@@ -0,0 +1,135 @@
+//
+// Copyright (c) 2011, Willow Garage, Inc.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//     * Neither the name of the Willow Garage, Inc. nor the names of its
+//       contributors may be used to endorse or promote products derived from
+//       this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+#include <gtest/gtest.h>
+#include <ecto/ecto.hpp>
+#include <ecto/edge.hpp>
+#include <ecto/plasm.hpp>
+#include <ecto/schedulers/singlethreaded.hpp>
+#include <ecto/schedulers/pipelined.hpp>
+
+#include "fixtures.hpp"
+
+#include <vector>
+
+using namespace ecto;
+using namespace ecto_test_fixtures;
+namespace {
+  //! doubles its input, a batch at a time when it can
+  struct Double
+  {
+    static void declare_io(const tendrils& p, tendrils& i, tendrils& o)
+    {
+      i.declare(&Double::in_, "in");
+      o.declare(&Double::out_, "out");
+    }
+    int process(const tendrils&, const tendrils&)
+    {
+      sizes.push_back(1);
+      *out_ = 2 * *in_;
+      return ecto::OK;
+    }
+    int process_batch(const tendrils_batch& in, tendrils_batch& out, std::size_t n)
+    {
+      sizes.push_back(n);
+      for (std::size_t j = 0; j < n; ++j)
+        out.get<int>("out", j) = 2 * in.get<int>("in", j);
+      return ecto::OK;
+    }
+    spore<int> in_, out_;
+    std::vector<std::size_t> sizes;
+  };
+
+  typedef chain<Double> doubling;
+
+  //! the values the sink saw are 2, 4, .. 2 * n, and the doubler's ports
+  //! hold the last tick's values however it was batched.
+  void expect_doubled(const doubling& c, unsigned n)
+  {
+    const std::vector<int>& seen = c.seen();
+    ASSERT_EQ(n, seen.size());
+    for (unsigned j = 0; j < n; ++j)
+      EXPECT_EQ(2 * int(j + 1), seen[j]);
+    EXPECT_EQ(n, c.collect->tick());
+    EXPECT_EQ(int(n), c.mid->inputs.get<int>("in"));
+    EXPECT_EQ(2 * int(n), c.mid->outputs.get<int>("out"));
+    EXPECT_EQ(n, c.mid->stats.ncalls);
+  }
+}
+
+TEST(Batch, Detected)
+{
+  EXPECT_TRUE(make<Double>()->batched());
+  EXPECT_FALSE(make<Count>()->batched());
+}
+
+TEST(Batch, Singlethreaded)
+{
+  doubling c;
+  schedulers::singlethreaded sched(c.p);
+  sched.batch(4);
+  sched.execute(10);
+  expect_doubled(c, 10);
+  std::vector<std::size_t> sizes = impl<Double>(c.mid).sizes;
+  ASSERT_EQ(3u, sizes.size());
+  EXPECT_EQ(4u, sizes[0]);
+  EXPECT_EQ(4u, sizes[1]);
+  EXPECT_EQ(2u, sizes[2]);
+}
+
+TEST(Batch, TickByTick)
+{
+  doubling c;
+  schedulers::singlethreaded sched(c.p);
+  sched.execute(3);
+  expect_doubled(c, 3);
+  EXPECT_EQ(std::vector<std::size_t>(3, 1), impl<Double>(c.mid).sizes);
+}
+
+TEST(Batch, BoundedEdge)
+{
+  doubling c(3);
+  schedulers::singlethreaded sched(c.p);
+  sched.batch(8);
+  sched.execute(7);
+  expect_doubled(c, 7);
+  std::vector<std::size_t> sizes = impl<Double>(c.mid).sizes;
+  ASSERT_EQ(3u, sizes.size());
+  EXPECT_EQ(3u, sizes[0]);
+  EXPECT_EQ(3u, sizes[1]);
+  EXPECT_EQ(1u, sizes[2]);
+}
+
+TEST(Batch, Pipelined)
+{
+  doubling c;
+  schedulers::pipelined sched(c.p);
+  sched.batch(4);
+  sched.execute(10, 3);
+  expect_doubled(c, 10);
+  EXPECT_EQ(3u, impl<Double>(c.mid).sizes.size());
+}
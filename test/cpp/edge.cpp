@@ -0,0 +1,556 @@
+//
+// Copyright (c) 2011, Willow Garage, Inc.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//     * Neither the name of the Willow Garage, Inc. nor the names of its
+//       contributors may be used to endorse or promote products derived from
+//       this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+#include <gtest/gtest.h>
+#include <ecto/all.hpp>
+#include <ecto/edge.hpp>
+#include <ecto/plasm.hpp>
+#include <ecto/schedulers/singlethreaded.hpp>
+#include <ecto/schedulers/multithreaded.hpp>
+#include <ecto/impl/graph_types.hpp>
+#include <ecto/impl/edge_queue.hpp>
+#include <ecto/atomic.hpp>
+#include <boost/thread.hpp>
+#include <set>
+#include <boost/lexical_cast.hpp>
+#include <boost/date_time/posix_time/posix_time.hpp>
+
+#include "fixtures.hpp"
+
+using namespace ecto;
+using namespace ecto_test_fixtures;
+using ecto::graph::edge;
+
+namespace {
+
+  void fill_and_drain(edge& e, unsigned n)
+  {
+    for (unsigned j = 0; j < n; ++j)
+    {
+      tendril t(j, "");
+      t.tick = j;
+      e.push_back(t);
+    }
+    EXPECT_EQ(n, e.size());
+    for (unsigned j = 0; j < n; ++j)
+    {
+      EXPECT_EQ(j, e.front().tick);
+      EXPECT_EQ(j, e.front().get<unsigned>());
+      e.pop_front();
+    }
+    EXPECT_EQ(0u, e.size());
+  }
+
+  struct producer
+  {
+    edge& e;
+    unsigned n;
+    producer(edge& e_, unsigned n_) : e(e_), n(n_) { }
+    void operator()()
+    {
+      tendril t(0u, "");
+      for (unsigned j = 0; j < n; ++j)
+      {
+        t << j;
+        t.tick = j;
+        e.push_back(t);
+      }
+    }
+  };
+
+  //! counts its copies, so the tests can tell a handle from a copy
+  struct Frame
+  {
+    static unsigned copies;
+    explicit Frame(int n = 0) : n(n) { }
+    Frame(const Frame& rhs) : n(rhs.n) { ++copies; }
+    Frame& operator=(const Frame& rhs) { n = rhs.n; ++copies; return *this; }
+    int n;
+  };
+  unsigned Frame::copies = 0;
+
+  struct Emit
+  {
+    static void declare_io(const tendrils&, tendrils&, tendrils& o)
+    {
+      o.declare(&Emit::out_, "out").shared_payload(true);
+    }
+    Emit() : n(0) { }
+    int process(const tendrils&, const tendrils&)
+    {
+      out_ << Frame(++n);
+      return ecto::OK;
+    }
+    spore<Frame> out_;
+    int n;
+  };
+
+  struct Look
+  {
+    static void declare_io(const tendrils&, tendrils& i, tendrils&)
+    {
+      i.declare(&Look::in_, "in");
+    }
+    int process(const tendrils&, const tendrils&)
+    {
+      seen.push_back(in_->n);
+      return ecto::OK;
+    }
+    spore<const Frame> in_;
+    std::vector<int> seen;
+  };
+
+  //! the tests that hold for either queue, run once with each
+  struct EdgeQueue : ::testing::TestWithParam<edge::queue_type>
+  { };
+}
+
+INSTANTIATE_TEST_CASE_P(Edge, EdgeQueue, ::testing::Values(edge::DEQUE, edge::RINGBUFFER));
+
+TEST(Edge, DequeFifo)
+{
+  edge e("out", "in");
+  EXPECT_EQ(edge::DEQUE, e.queue());
+  fill_and_drain(e, 100);
+}
+
+TEST(Edge, RingbufferFifo)
+{
+  edge e("out", "in", edge::RINGBUFFER);
+  fill_and_drain(e, 3);
+  // more than fits in the ring, so some values spill
+  fill_and_drain(e, 100);
+  fill_and_drain(e, 5);
+}
+
+TEST(Edge, RingbufferSizedToBound)
+{
+  edge e("out", "in", edge::RINGBUFFER);
+  e.bound(40, edge::DROP_NEWEST);
+  fill_and_drain(e, 40);
+  // a ring big enough for the bound never spills, a full edge drops instead
+  graph::ring_queue<graph::erased_slot> q;
+  q.reserve(40);
+  for (unsigned j = 0; j < 40; ++j)
+    q.push_back(tendril(j, ""));
+  EXPECT_EQ(0u, q.nspilled_);
+  EXPECT_EQ(40u, q.size());
+  for (unsigned j = 0; j < 41; ++j)
+    e.push_back(tendril(j, ""));
+  EXPECT_EQ(40u, e.size());
+  EXPECT_EQ(1u, e.dropped());
+}
+
+TEST(Edge, RingbufferGrows)
+{
+  graph::ring_queue<graph::erased_slot> q;
+  for (unsigned j = 0; j < 20; ++j)
+  {
+    tendril t(j, "");
+    t.tick = j;
+    q.push_back(t);
+  }
+  EXPECT_NE(0u, q.nspilled_);
+  // what the ring and its spill hold is moved into the bigger ring, in order
+  q.reserve(40);
+  EXPECT_EQ(0u, q.nspilled_);
+  ASSERT_EQ(20u, q.size());
+  for (unsigned j = 0; j < 20; ++j)
+  {
+    EXPECT_EQ(j, q.front_tick());
+    EXPECT_EQ(j, q.front().get<unsigned>());
+    q.pop_front();
+  }
+}
+
+TEST(Edge, RingbufferTwoThreads)
+{
+  const unsigned n = 100000;
+  edge e("out", "in", edge::RINGBUFFER);
+  boost::thread t(producer(e, n));
+  unsigned j = 0;
+  while (j < n)
+  {
+    if (e.size() == 0)
+      continue;
+    ASSERT_EQ(j, e.front().tick);
+    ASSERT_EQ(j, e.front().get<unsigned>());
+    e.pop_front();
+    ++j;
+  }
+  t.join();
+  EXPECT_EQ(0u, e.size());
+}
+
+TEST(Edge, SlotsAreRecycled)
+{
+  edge e("out", "in");
+  std::set<const double*> values;
+  for (unsigned j = 0; j < 100; ++j)
+  {
+    e.push_back(tendril(double(j), ""));
+    e.push_back(tendril(double(j), ""));
+    values.insert(&e.front().get<double>());
+    e.pop_front();
+    values.insert(&e.front().get<double>());
+    e.pop_front();
+  }
+  // values are assigned into the same few slots over and over
+  EXPECT_GE(4u, values.size());
+}
+
+TEST_P(EdgeQueue, MoveBack)
+{
+  edge e("out", "in", GetParam());
+  tendril out(std::string(), "");
+  for (unsigned j = 0; j < 40; ++j)
+  {
+    out.get<std::string>() = boost::lexical_cast<std::string>(j);
+    out.tick = j;
+    e.move_back(out);
+  }
+  for (unsigned j = 0; j < 40; ++j)
+  {
+    EXPECT_EQ(j, e.front().tick);
+    EXPECT_EQ(boost::lexical_cast<std::string>(j), e.front().get<std::string>());
+    e.pop_front();
+  }
+  EXPECT_EQ(0u, e.size());
+}
+
+TEST_P(EdgeQueue, DropNewest)
+{
+  edge e("out", "in", GetParam());
+  e.bound(3, edge::DROP_NEWEST);
+  EXPECT_TRUE(e.lossy());
+  for (unsigned j = 0; j < 10; ++j)
+    e.push_back(tendril(j, ""));
+  EXPECT_EQ(3u, e.size());
+  EXPECT_EQ(7u, e.dropped());
+  tendril in;
+  for (unsigned j = 0; j < 3; ++j)
+  {
+    e.take_front(in);
+    EXPECT_EQ(j, in.get<unsigned>());
+  }
+}
+
+TEST_P(EdgeQueue, DropOldest)
+{
+  edge e("out", "in", GetParam());
+  e.bound(3, edge::DROP_OLDEST);
+  for (unsigned j = 0; j < 10; ++j)
+    e.push_back(tendril(j, ""));
+  EXPECT_EQ(3u, e.size());
+  EXPECT_EQ(7u, e.dropped());
+  tendril in;
+  for (unsigned j = 7; j < 10; ++j)
+  {
+    e.take_front(in);
+    EXPECT_EQ(j, in.get<unsigned>());
+  }
+}
+
+namespace
+{
+  //! how many values Source has sent, and the most it was ever ahead of Sink
+  volatile std::size_t sent = 0;
+  std::size_t most_ahead = 0;
+
+  struct Source
+  {
+    static void declare_io(const tendrils& p, tendrils& i, tendrils& o)
+    {
+      o.declare(&Source::out_, "out");
+    }
+    int process(const tendrils&, const tendrils&)
+    {
+      *out_ = fetch_and_add(sent, std::size_t(1)) + 1;
+      return ecto::OK;
+    }
+    spore<std::size_t> out_;
+  };
+
+  struct Sink
+  {
+    static void declare_io(const tendrils& p, tendrils& i, tendrils& o)
+    {
+      i.declare(&Sink::in_, "in");
+    }
+    int process(const tendrils&, const tendrils&)
+    {
+      most_ahead = std::max(most_ahead, load_acquire(sent) - *in_);
+      boost::this_thread::sleep(boost::posix_time::milliseconds(1));
+      return ecto::OK;
+    }
+    spore<std::size_t> in_;
+  };
+
+  void slow_consumer(edge& e, unsigned n)
+  {
+    tendril in;
+    for (unsigned j = 0; j < n; ++j)
+    {
+      while (e.size() == 0)
+        boost::this_thread::yield();
+      boost::this_thread::sleep(boost::posix_time::milliseconds(1));
+      e.take_front(in);
+      ASSERT_EQ(j, in.get<unsigned>());
+    }
+  }
+}
+
+TEST_P(EdgeQueue, Block)
+{
+  edge e("out", "in", GetParam());
+  e.bound(2);
+  EXPECT_FALSE(e.lossy());
+  boost::thread t(boost::bind(slow_consumer, boost::ref(e), 20));
+  for (unsigned j = 0; j < 20; ++j)
+  {
+    e.push_back(tendril(j, ""));
+    EXPECT_GE(2u, e.size());
+  }
+  t.join();
+  EXPECT_EQ(0u, e.dropped());
+  EXPECT_LT(0, e.blocked_time().total_microseconds());
+}
+
+TEST(Edge, BlockThreaded)
+{
+  // the source and sink share no strand, so the source runs on all four
+  // threads and its producer waits for room, never more than the capacity
+  // and the value it is pushing ahead of the sink.
+  most_ahead = 0;
+  plasm::ptr p(new plasm);
+  cell::ptr source = make<Source>(), sink = make<Sink>();
+  p->connect(source, "out", sink, "in", 2);
+  schedulers::multithreaded sched(p);
+  sched.execute(40, 4);
+  EXPECT_EQ(40u, sink->stats.ncalls);
+  EXPECT_GE(3u, most_ahead);
+}
+
+TEST(Edge, BlockThrottlesSharedStrand)
+{
+  // a producer waiting for room would hold the strand its consumer needs,
+  // so the scheduler holds the source back and the producer never waits.
+  most_ahead = 0;
+  plasm::ptr p(new plasm);
+  cell::ptr source = make<Source>(), sink = make<Sink>();
+  ecto::strand s;
+  source->set_strand(s);
+  sink->set_strand(s);
+  p->connect(source, "out", sink, "in", 2);
+  schedulers::multithreaded sched(p);
+  sched.execute(40, 4);
+  graph::graph_t::edge_iterator b, e;
+  boost::tie(b, e) = boost::edges(p->graph());
+  EXPECT_EQ(40u, sink->stats.ncalls);
+  EXPECT_GE(2u, most_ahead);
+  EXPECT_EQ(0, p->graph()[*b]->blocked_time().total_microseconds());
+}
+
+TEST(Edge, BoundedConnect)
+{
+  plasm::ptr p(new plasm);
+  cell::ptr gen = make("ecto_test::Generate<double>");
+  cell::ptr inc = make("ecto_test::Increment");
+  p->connect(gen, "out", inc, "in", 4, edge::DROP_OLDEST);
+  graph::graph_t::edge_iterator b, e;
+  boost::tie(b, e) = boost::edges(p->graph());
+  EXPECT_EQ(4u, p->graph()[*b]->capacity());
+  EXPECT_EQ(edge::DROP_OLDEST, p->graph()[*b]->overflow());
+  // single threaded never gets ahead, nothing is dropped
+  schedulers::singlethreaded sched(p);
+  sched.execute(10);
+  EXPECT_EQ(0u, p->graph()[*b]->dropped());
+  EXPECT_EQ(10u, inc->tick());
+}
+
+TEST(Edge, DroppedTicksAreSkipped)
+{
+  plasm::ptr p(new plasm);
+  cell::ptr gen = make("ecto_test::Generate<double>");
+  cell::ptr inc = make("ecto_test::Increment");
+  inc->parameters["delay"] << 2u;
+  p->connect(gen, "out", inc, "in", 1, edge::DROP_NEWEST);
+  schedulers::multithreaded sched(p);
+  sched.execute(40, 4);
+  graph::graph_t::edge_iterator b, e;
+  boost::tie(b, e) = boost::edges(p->graph());
+  // every tick is either processed or skipped for a dropped value, the
+  // last one may be among the dropped, leaving inc a tick or more behind
+  EXPECT_GE(40u, inc->tick());
+  EXPECT_EQ(40u, inc->stats.ncalls + p->graph()[*b]->dropped());
+}
+
+TEST_P(EdgeQueue, Typed)
+{
+  graph::typed_edge_registrar<double>::ensure();
+  std::size_t type_id = types::id_of<double>();
+  edge e("out", "in", GetParam(), type_id);
+  EXPECT_EQ(type_id, e.value_type());
+  tendril out(0.0, ""), in(0.0, "");
+  for (unsigned j = 0; j < 40; ++j)
+  {
+    out.get<double>() = j;
+    out.tick = j;
+    if (j % 2)
+      e.move_back(out);
+    else
+      e.push_back(out);
+  }
+  EXPECT_EQ(0.0, e.front().get<double>());
+  for (unsigned j = 0; j < 40; ++j)
+  {
+    e.take_front(in);
+    EXPECT_EQ(j, in.tick);
+    EXPECT_EQ(double(j), in.get<double>());
+  }
+  EXPECT_EQ(0u, e.size());
+  // no typed queue for none, the edge is type erased
+  edge none_edge("out", "in", GetParam(), types::id_of<tendril::none>());
+  EXPECT_EQ(0u, none_edge.value_type());
+}
+
+TEST_P(EdgeQueue, TypedRetyped)
+{
+  // a port that took on another type since connect goes by with its own type
+  graph::typed_edge_registrar<double>::ensure();
+  edge e("out", "in", GetParam(), types::id_of<double>());
+  tendril out(std::string("text"), ""), in(std::string(), "");
+  out.tick = 3;
+  e.push_back(out);
+  EXPECT_EQ("text", e.front().get<std::string>());
+  e.take_front(in);
+  EXPECT_EQ("text", in.get<std::string>());
+  EXPECT_EQ(3u, in.tick);
+  // and a double isn't swapped into an input that no longer holds one
+  e.push_back(tendril(1.0, ""));
+  EXPECT_THROW(e.take_front(in), except::TypeMismatch);
+  EXPECT_EQ("text", in.get<std::string>());
+  // which stays on the edge
+  ASSERT_EQ(1u, e.size());
+  EXPECT_EQ(1.0, e.front().get<double>());
+}
+
+TEST_P(EdgeQueue, SharedPayload)
+{
+  // a frozen value goes by as a handle on typed and type erased edges alike,
+  // and an edge keeps no reference to it once it is popped or taken.
+  graph::typed_edge_registrar<std::string>::ensure();
+  std::size_t type_ids[] = { types::id_of<std::string>(), 0 };
+  for (unsigned t = 0; t < 2; ++t)
+  {
+    edge e("out", "in", GetParam(), type_ids[t]);
+    EXPECT_EQ(type_ids[t], e.value_type());
+    tendril out(std::string("payload"), ""), in(std::string(), "");
+    out.freeze();
+    const std::string* value = &static_cast<const tendril&>(out).get<std::string>();
+    e.push_back(out);
+    EXPECT_EQ(value, &static_cast<const tendril&>(e.front()).get<std::string>());
+    e.take_front(in);
+    EXPECT_TRUE(in.frozen());
+    EXPECT_EQ(value, &static_cast<const tendril&>(in).get<std::string>());
+    // out lets go of it for its next value, in is then the only holder and takes it back
+    out << std::string("written");
+    EXPECT_EQ(value, &in.get<std::string>());
+    EXPECT_EQ("payload", in.get<std::string>());
+
+    out.freeze();
+    value = &static_cast<const tendril&>(out).get<std::string>();
+    e.push_back(out);
+    e.pop_front();
+    EXPECT_EQ(value, &out.get<std::string>());
+    EXPECT_EQ(0u, e.size());
+  }
+}
+
+TEST(Edge, SharedPayloadFanOut)
+{
+  // every consumer reads the one frame the producer wrote, tick after tick
+  plasm::ptr p(new plasm);
+  cell::ptr emit = make<Emit>();
+  std::vector<cell::ptr> looks;
+  for (unsigned j = 0; j < 3; ++j)
+  {
+    looks.push_back(make<Look>());
+    p->connect(emit, "out", looks[j], "in");
+  }
+  Frame::copies = 0;
+  schedulers::singlethreaded sched(p);
+  sched.execute(5);
+  // the only copy a tick is the one Emit writes into its port
+  EXPECT_EQ(5u, Frame::copies);
+  for (unsigned j = 0; j < looks.size(); ++j)
+  {
+    const std::vector<int>& seen = impl<Look>(looks[j]).seen;
+    ASSERT_EQ(5u, seen.size());
+    EXPECT_EQ(5, seen.back());
+  }
+}
+
+TEST(Edge, TypedConnect)
+{
+  plasm::ptr p(new plasm);
+  cell::ptr gen = make("ecto_test::Generate<double>");
+  cell::ptr inc = make("ecto_test::Increment");
+  p->connect(gen, "out", inc, "in");
+  graph::graph_t::edge_iterator b, e;
+  boost::tie(b, e) = boost::edges(p->graph());
+  EXPECT_EQ(types::id_of<double>(), p->graph()[*b]->value_type());
+  schedulers::singlethreaded sched(p);
+  sched.execute(5);
+  // generate counts 0, 2, 4, 6, 8
+  EXPECT_EQ(9.0, inc->outputs.get<double>("out"));
+}
+
+TEST(Edge, ChangeQueue)
+{
+  edge e("out", "in");
+  e.push_back(tendril(1, ""));
+  EXPECT_THROW(e.queue(edge::RINGBUFFER), except::EctoException);
+  e.pop_front();
+  e.queue(edge::RINGBUFFER);
+  EXPECT_EQ(edge::RINGBUFFER, e.queue());
+  fill_and_drain(e, 20);
+}
+
+TEST(Edge, PlasmEdgeQueue)
+{
+  plasm p;
+  EXPECT_EQ(edge::DEQUE, p.edge_queue());
+  cell::ptr gen = make("ecto_test::Generate<double>");
+  cell::ptr inc = make("ecto_test::Increment");
+  p.connect(gen, "out", inc, "in");
+  p.edge_queue(edge::RINGBUFFER);
+  EXPECT_EQ(edge::RINGBUFFER, p.edge_queue());
+  graph::graph_t::edge_iterator b, e;
+  boost::tie(b, e) = boost::edges(p.graph());
+  EXPECT_EQ(edge::RINGBUFFER, p.graph()[*b]->queue());
+}
@@ -193,6 +193,41 @@ TEST(Exceptions, ProcessException)
       ecto::except::EctoException);
 }
 
+TEST(Exceptions, ProcessRunningException)
+{
+  cell::ptr m(new cell_<ProcessException>);
+  m->declare_params();
+  m->declare_io();
+  m->start();
+  try
+    {
+      m->process_running();
+      FAIL() << "process_running() did not throw";
+    }
+  catch (except::CellException& e)
+    {
+      const std::string* function = boost::get_error_info<except::function_name>(e);
+      ASSERT_TRUE(function);
+      EXPECT_EQ("process", *function);
+      EXPECT_TRUE(boost::get_error_info<except::cell_name>(e));
+    }
+  //the failed tick leaves the cell running.
+  EXPECT_THROW(m->process_running(), except::CellException);
+}
+
+TEST(Exceptions, ProcessRunningNotConnected)
+{
+  cell::ptr m(new cell_<WrongType>);
+  m->declare_params();
+  m->declare_io();
+  m->inputs["d"]->required(true);
+  m->start();
+  EXPECT_THROW(m->process_running(), except::NotConnected);
+  m->inputs["d"] << 1.0;
+  m->inputs["d"]->user_supplied(true); //as an edge leaves it
+  EXPECT_THROW(m->process_running(), except::TypeMismatch); //WrongType's own error
+}
+
 TEST(Exceptions, NotExist)
 {
   std::string
@@ -0,0 +1,130 @@
+//
+// Copyright (c) 2011, Willow Garage, Inc.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//     * Neither the name of the Willow Garage, Inc. nor the names of its
+//       contributors may be used to endorse or promote products derived from
+//       this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+#pragma once
+#include <ecto/ecto.hpp>
+#include <ecto/plasm.hpp>
+#include <ecto/registry.hpp>
+
+#include <vector>
+
+//
+//  Cells and helpers shared by the scheduler tests, built by hand rather
+//  than registered, so the tests can reach into them with impl<T>().
+//
+namespace ecto_test_fixtures
+{
+  using namespace ecto;
+
+  //! 1, 2, 3, ..
+  struct Count
+  {
+    static void declare_io(const tendrils& p, tendrils& i, tendrils& o)
+    {
+      o.declare(&Count::out_, "out");
+    }
+    Count() : n_(0) { }
+    int process(const tendrils&, const tendrils&)
+    {
+      *out_ = ++n_;
+      return ecto::OK;
+    }
+    spore<int> out_;
+    int n_;
+  };
+
+  //! records what it sees and passes it on, its input of rate Rate
+  //! (see tendril::rate(), sdf only fires it if Rate is 1)
+  template <unsigned Rate = 1>
+  struct Collect
+  {
+    static void declare_io(const tendrils& p, tendrils& i, tendrils& o)
+    {
+      i.declare(&Collect::in_, "in");
+      i["in"]->rate(Rate);
+      o.declare(&Collect::out_, "out");
+    }
+    int process(const tendrils&, const tendrils&)
+    {
+      seen.push_back(*in_);
+      *out_ = *in_;
+      return ecto::OK;
+    }
+    spore<int> in_, out_;
+    std::vector<int> seen;
+  };
+
+  //! a cell of T, its ports declared
+  template <typename T>
+  cell_ptr make()
+  {
+    cell_ptr c(new cell_<T>);
+    c->declare_params();
+    c->declare_io();
+    return c;
+  }
+
+  //! a cell of the registered type, e.g. "ecto_test::Increment", its ports declared
+  inline cell_ptr make(const std::string& type)
+  {
+    cell_ptr c = registry::create(type);
+    c->declare_params();
+    c->declare_io();
+    return c;
+  }
+
+  //! the instance of T behind c, created if the cell has not run yet
+  template <typename T>
+  T& impl(const cell_ptr& c)
+  {
+    c->init();
+    return *boost::static_pointer_cast<cell_<T> >(c)->impl;
+  }
+
+  //! Count into the "in" of a Mid, its "out" into Collect
+  template <typename Mid>
+  struct chain
+  {
+    explicit chain(std::size_t capacity = 0)
+      : p(new plasm)
+      , count(make<Count>())
+      , mid(make<Mid>())
+      , collect(make<Collect<> >())
+    {
+      p->connect(count, "out", mid, "in", capacity);
+      p->connect(mid, "out", collect, "in");
+    }
+
+    const std::vector<int>& seen() const
+    {
+      return impl<Collect<> >(collect).seen;
+    }
+
+    plasm::ptr p;
+    cell_ptr count, mid, collect;
+  };
+}
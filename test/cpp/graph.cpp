@@ -28,7 +28,12 @@
 #include <gtest/gtest.h>
 #include <ecto/ecto.hpp>
 #include <ecto/schedulers/singlethreaded.hpp>
+#include <ecto/schedulers/multithreaded.hpp>
+#include <ecto/schedulers/dataflow.hpp>
+#include <ecto/schedulers/pipelined.hpp>
 #include <ecto/plasm.hpp>
+#include <ecto/affinity.hpp>
+#include <ecto/impl/graph_types.hpp>
 
 #define STRINGDIDLY(A) std::string(#A)
 
@@ -62,6 +67,71 @@ namespace {
     }
   };
 
+  // gen fans out to two increments that join again in an add
+  ecto::plasm::ptr diamond(ecto::cell::ptr& add)
+  {
+    ecto::plasm::ptr p(new ecto::plasm);
+    ecto::cell::ptr gen = ecto::registry::create("ecto_test::Generate<double>"),
+      inc1 = ecto::registry::create("ecto_test::Increment"),
+      inc2 = ecto::registry::create("ecto_test::Increment");
+    add = ecto::registry::create("ecto_test::Add");
+    gen->declare_params();
+    gen->declare_io();
+    inc1->declare_params();
+    inc1->declare_io();
+    inc2->declare_params();
+    inc2->parameters["amount"] << 10.0;
+    inc2->declare_io();
+    add->declare_params();
+    add->declare_io();
+    p->connect(gen, "out", inc1, "in");
+    p->connect(gen, "out", inc2, "in");
+    p->connect(inc1, "out", add, "left");
+    p->connect(inc2, "out", add, "right");
+    return p;
+  }
+
+  //! stands for a plasm it would run once per tick, like a BlackBox
+  struct Box
+  {
+    ecto::plasm::ptr subgraph() const
+    {
+      return plasm_;
+    }
+    ecto::plasm::ptr plasm_;
+  };
+
+  ecto::cell::ptr make(const std::string& type)
+  {
+    ecto::cell::ptr c = ecto::registry::create(type);
+    c->declare_params();
+    c->declare_io();
+    return c;
+  }
+
+  //! a box of two increments in a row, exporting the first's in and the last's out
+  ecto::cell::ptr box_of_increments()
+  {
+    ecto::plasm::ptr inner(new ecto::plasm);
+    ecto::cell::ptr first = make("ecto_test::Increment"), last = make("ecto_test::Increment");
+    inner->connect(first, "out", last, "in");
+    cell_<Box>::ptr box(new cell_<Box>);
+    ecto::cell::ptr base(box);
+    base->inputs.declare("in", first->inputs["in"]);
+    base->outputs.declare("out", last->outputs["out"]);
+    base->configure(); //creates the impl
+    box->impl->plasm_ = inner;
+    return base;
+  }
+
+  ecto::cell::ptr find(const ecto::plasm::ptr& p, const std::string& type)
+  {
+    std::vector<ecto::cell::ptr> cells = p->cells();
+    for (std::size_t j = 0; j < cells.size(); ++j)
+      if (cells[j]->type() == type)
+        return cells[j];
+    return ecto::cell::ptr();
+  }
 }
 TEST(Plasm, Viz)
 {
@@ -99,6 +169,238 @@ TEST(Plasm, Passthrough)
   EXPECT_TRUE(out == 5.0);
 }
 
+TEST(Plasm, DiamondSinglethreaded)
+{
+  ecto::cell::ptr add;
+  ecto::plasm::ptr p = diamond(add);
+  ecto::schedulers::singlethreaded sched(p);
+  sched.execute(5);
+  // gen emits 0,2,..,8: (8+1) + (8+10)
+  EXPECT_EQ(27.0, add->outputs.get<double>("out"));
+  sched.execute(1);
+  EXPECT_EQ(31.0, add->outputs.get<double>("out"));
+}
+
+TEST(Plasm, DiamondMultithreaded)
+{
+  ecto::cell::ptr add;
+  ecto::plasm::ptr p = diamond(add);
+  ecto::schedulers::multithreaded sched(p);
+  sched.execute(5, 3);
+  EXPECT_EQ(5u, add->tick());
+  EXPECT_EQ(27.0, add->outputs.get<double>("out"));
+}
+
+TEST(Plasm, DiamondDataflow)
+{
+  ecto::cell::ptr add;
+  ecto::plasm::ptr p = diamond(add);
+  ecto::schedulers::dataflow sched(p);
+  sched.ticks_in_flight(3);
+  sched.execute(5, 4);
+  EXPECT_EQ(5u, add->tick());
+  EXPECT_EQ(27.0, add->outputs.get<double>("out"));
+  sched.execute(1, 4);
+  EXPECT_EQ(31.0, add->outputs.get<double>("out"));
+}
+
+TEST(Plasm, DiamondPipelined)
+{
+  ecto::cell::ptr add;
+  ecto::plasm::ptr p = diamond(add);
+  ecto::schedulers::pipelined sched(p);
+  sched.max_in_flight(3);
+  sched.execute(5, 3);
+  EXPECT_EQ(3u, sched.layout().size());
+  EXPECT_EQ(5u, add->tick());
+  EXPECT_EQ(27.0, add->outputs.get<double>("out"));
+  sched.execute(1, 3);
+  EXPECT_EQ(31.0, add->outputs.get<double>("out"));
+}
+
+TEST(Plasm, DiamondPipelinedManual)
+{
+  ecto::cell::ptr add;
+  ecto::plasm::ptr p = diamond(add);
+  ecto::schedulers::pipelined sched(p);
+  sched.stage(add, 5);
+  sched.execute(5);
+  // gen and the increments follow gen into stage 0, add is alone after it
+  std::vector<std::vector<ecto::cell::ptr> > layout = sched.layout();
+  ASSERT_EQ(2u, layout.size());
+  EXPECT_EQ(3u, layout[0].size());
+  ASSERT_EQ(1u, layout[1].size());
+  EXPECT_EQ(add, layout[1][0]);
+  EXPECT_EQ(27.0, add->outputs.get<double>("out"));
+}
+
+TEST(Plasm, PipelinedStageBeforeProducer)
+{
+  ecto::cell::ptr add;
+  ecto::plasm::ptr p = diamond(add);
+  ecto::schedulers::pipelined sched(p);
+  sched.stage(find(p, "ecto_test::Generate<double>"), 1);
+  sched.stage(add, 0);
+  EXPECT_THROW(sched.execute(1), ecto::except::EctoException);
+  ecto::schedulers::pipelined automatic(p);
+  automatic.execute(5);
+  EXPECT_EQ(27.0, add->outputs.get<double>("out"));
+}
+
+TEST(Plasm, DiamondPinned)
+{
+  ecto::cell::ptr add;
+  ecto::plasm::ptr p = diamond(add);
+  ecto::schedulers::dataflow sched(p);
+  std::vector<unsigned> cpus = ecto::affinity::physical_cores();
+  ASSERT_FALSE(cpus.empty());
+  sched.cpus(cpus);
+  sched.numa_node(add, ecto::affinity::node_of(cpus[0]));
+  sched.execute(5);
+  // one worker per cpu, each pinned to its own
+  std::vector<int> placement = sched.placement();
+  ASSERT_EQ(cpus.size(), placement.size());
+  for (std::size_t j = 0; j < cpus.size(); ++j)
+    EXPECT_EQ(int(cpus[j]), placement[j]);
+  EXPECT_EQ(27.0, add->outputs.get<double>("out"));
+}
+
+TEST(Plasm, PipelinedOnNode)
+{
+  ecto::cell::ptr add;
+  ecto::plasm::ptr p = diamond(add);
+  ecto::schedulers::pipelined sched(p);
+  int node = ecto::affinity::node_of(ecto::affinity::cpus().back());
+  sched.stage(add, 1);
+  sched.numa_node(add, node);
+  sched.execute(5);
+  std::vector<int> placement = sched.placement();
+  ASSERT_EQ(2u, placement.size());
+  EXPECT_EQ(-1, placement[0]);
+  ASSERT_NE(-1, placement[1]);
+  EXPECT_EQ(node, ecto::affinity::node_of(placement[1]));
+  EXPECT_EQ(27.0, add->outputs.get<double>("out"));
+}
+
+namespace {
+  void record(std::vector<ecto::cell*>& order, ecto::cell& c, bool starting)
+  {
+    if (starting)
+      order.push_back(&c);
+  }
+}
+
+TEST(Plasm, DataflowPriority)
+{
+  ecto::cell::ptr add;
+  ecto::plasm::ptr p = diamond(add);
+  ecto::cell::ptr low = find(p, "ecto_test::Increment"), high;
+  std::vector<ecto::cell::ptr> cells = p->cells();
+  for (std::size_t j = 0; j < cells.size(); ++j)
+    if (cells[j]->type() == low->type() && cells[j] != low)
+      high = cells[j];
+  ASSERT_TRUE(high);
+  high->priority(1);
+  std::vector<ecto::cell*> order;
+  low->bsig_process.connect(boost::bind(&record, boost::ref(order), _1, _2));
+  high->bsig_process.connect(boost::bind(&record, boost::ref(order), _1, _2));
+  ecto::schedulers::dataflow sched(p);
+  sched.execute(5, 1);
+  // with one worker both are ready together on every tick
+  ASSERT_EQ(10u, order.size());
+  for (std::size_t j = 0; j < order.size(); j += 2)
+  {
+    EXPECT_EQ(high.get(), order[j]);
+    EXPECT_EQ(low.get(), order[j + 1]);
+  }
+  EXPECT_EQ(27.0, add->outputs.get<double>("out"));
+}
+
+TEST(Plasm, DataflowDeadline)
+{
+  ecto::cell::ptr add;
+  ecto::plasm::ptr p = diamond(add);
+  p->deadline(boost::posix_time::seconds(10));
+  ecto::schedulers::dataflow sched(p);
+  sched.execute(5, 2);
+  EXPECT_NE(std::string::npos, sched.stats().find("deadline missed by 0 of 5 ticks"));
+  EXPECT_EQ(27.0, add->outputs.get<double>("out"));
+}
+
+TEST(Plasm, DataflowDeadlineTwoSources)
+{
+  ecto::plasm::ptr p(new ecto::plasm);
+  ecto::cell::ptr left = make("ecto_test::Generate<double>"),
+    right = make("ecto_test::Generate<double>"), add = make("ecto_test::Add");
+  p->connect(left, "out", add, "left");
+  p->connect(right, "out", add, "right");
+  p->deadline(boost::posix_time::seconds(10));
+  ecto::schedulers::dataflow sched(p);
+  sched.execute(100, 4);
+  // both sources claim every tick, each of its tasks is due at the same time
+  std::string stats = sched.stats();
+  EXPECT_NE(std::string::npos, stats.find("deadline missed by 0 of 100 ticks"));
+  EXPECT_EQ(std::string::npos, stats.find("different deadlines"));
+  EXPECT_EQ(2 * left->outputs.get<double>("out"), add->outputs.get<double>("out"));
+}
+
+TEST(Plasm, Flatten)
+{
+  ecto::plasm::ptr p(new ecto::plasm);
+  ecto::cell::ptr gen = make("ecto_test::Generate<double>"), add = make("ecto_test::Add"),
+    box = box_of_increments(), nested = box_of_increments();
+  p->connect(gen, "out", box, "in");
+  p->connect(box, "out", nested, "in");
+  p->connect(nested, "out", add, "left");
+  p->connect(gen, "out", add, "right");
+  EXPECT_EQ(2u, p->flatten());
+  EXPECT_EQ(6u, p->size());
+  std::vector<ecto::cell::ptr> cells = p->cells();
+  EXPECT_TRUE(std::find(cells.begin(), cells.end(), box) == cells.end());
+  EXPECT_EQ(0u, p->flatten());
+
+  ecto::schedulers::dataflow sched(p);
+  sched.execute(5, 2);
+  double g = gen->outputs.get<double>("out");
+  EXPECT_EQ(2 * g + 4, add->outputs.get<double>("out"));
+  //the box's tendrils are still those of the cells it stood for
+  EXPECT_EQ(g + 2, box->outputs.get<double>("out"));
+}
+
+TEST(Plasm, FlattenSharedInput)
+{
+  //one exported input, declared on two increments side by side
+  ecto::plasm::ptr inner(new ecto::plasm);
+  ecto::cell::ptr first = make("ecto_test::Increment"), second = make("ecto_test::Increment");
+  second->parameters["amount"] << 10.0;
+  second->inputs["in"] = first->inputs["in"];
+  inner->insert(first);
+  inner->insert(second);
+  cell_<Box>::ptr b(new cell_<Box>);
+  ecto::cell::ptr box(b);
+  box->inputs.declare("in", first->inputs["in"]);
+  box->outputs.declare("left", first->outputs["out"]);
+  box->outputs.declare("right", second->outputs["out"]);
+  box->configure();
+  b->impl->plasm_ = inner;
+
+  ecto::plasm::ptr p(new ecto::plasm);
+  ecto::cell::ptr gen = make("ecto_test::Generate<double>"), add = make("ecto_test::Add");
+  p->connect(gen, "out", box, "in");
+  p->connect(box, "left", add, "left");
+  p->connect(box, "right", add, "right");
+  EXPECT_EQ(1u, p->flatten());
+  //gen feeds both increments
+  EXPECT_EQ(4u, boost::num_edges(p->graph()));
+
+  ecto::schedulers::singlethreaded sched(p);
+  sched.execute(5);
+  double g = gen->outputs.get<double>("out");
+  EXPECT_EQ(g + 1, first->outputs.get<double>("out"));
+  EXPECT_EQ(g + 10, second->outputs.get<double>("out"));
+  EXPECT_EQ(2 * g + 11, add->outputs.get<double>("out"));
+}
+
 TEST(Plasm, Registry)
 {
   ecto::cell::ptr add = ecto::registry::create("ecto_test::Add");
@@ -0,0 +1,98 @@
+//
+// Copyright (c) 2011, Willow Garage, Inc.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//     * Neither the name of the Willow Garage, Inc. nor the names of its
+//       contributors may be used to endorse or promote products derived from
+//       this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+#include <gtest/gtest.h>
+#include <ecto/ecto.hpp>
+#include <ecto/hook.hpp>
+
+#include <boost/bind.hpp>
+
+using namespace ecto;
+
+namespace
+{
+  void count(int& n, int by)
+  {
+    n += by;
+  }
+
+  void add(int& total, int i)
+  {
+    total += i;
+  }
+}
+
+TEST(HookTest, ConnectFireDisconnect)
+{
+  hook<void(int&, int)> h;
+  EXPECT_TRUE(h.empty());
+  int n = 0;
+  h(n, 1);
+  EXPECT_EQ(0, n);
+
+  hook<void(int&, int)>::connection c1 = h.connect(&count);
+  hook<void(int&, int)>::connection c2 = h.connect(&add);
+  EXPECT_FALSE(h.empty());
+  EXPECT_TRUE(c1.connected());
+  h(n, 2);
+  EXPECT_EQ(4, n);
+
+  c1.disconnect();
+  EXPECT_FALSE(c1.connected());
+  h(n, 3);
+  EXPECT_EQ(7, n);
+
+  c2.disconnect();
+  EXPECT_TRUE(h.empty());
+  h(n, 3);
+  EXPECT_EQ(7, n);
+}
+
+TEST(HookTest, ConnectionOutlivesHook)
+{
+  hook<void(int&, int)>::connection c;
+  {
+    hook<void(int&, int)> h;
+    c = h.connect(&count);
+    EXPECT_TRUE(c.connected());
+  }
+  EXPECT_FALSE(c.connected());
+  c.disconnect();
+}
+
+TEST(HookTest, TendrilCallback)
+{
+  tendril_ptr t = make_tendril<int>();
+  int seen = 0;
+  t->set_callback<int>(boost::bind(&count, boost::ref(seen), _1));
+  *t << 5;
+  t->dirty(true);
+  t->notify();
+  EXPECT_EQ(5, seen);
+  t->notify();
+  EXPECT_EQ(5, seen);
+}
@@ -0,0 +1,228 @@
+//
+// Copyright (c) 2011, Willow Garage, Inc.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//     * Neither the name of the Willow Garage, Inc. nor the names of its
+//       contributors may be used to endorse or promote products derived from
+//       this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+#include <gtest/gtest.h>
+#include <ecto/ecto.hpp>
+#include <ecto/edge.hpp>
+#include <ecto/plasm.hpp>
+#include <ecto/schedulers/sdf.hpp>
+#include <ecto/impl/graph_types.hpp>
+
+#include "fixtures.hpp"
+
+#include <vector>
+
+using namespace ecto;
+using namespace ecto_test_fixtures;
+namespace {
+  //! Count, two values a firing
+  struct Twice
+  {
+    static void declare_io(const tendrils& p, tendrils& i, tendrils& o)
+    {
+      o.declare(&Twice::out_, "out");
+      o["out"]->rate(2);
+    }
+    Twice() : n_(0) { }
+    int process(const tendrils&, const tendrils&)
+    {
+      *out_ = ++n_;
+      return ecto::OK;
+    }
+    int process_batch(const tendrils_batch&, tendrils_batch& out, std::size_t)
+    {
+      out.get<int>("out", 0) = ++n_;
+      out.get<int>("out", 1) = ++n_;
+      return ecto::OK;
+    }
+    spore<int> out_;
+    int n_;
+  };
+
+  //! Collect, Rate values a firing, passing on the last
+  template<unsigned Rate>
+  struct Gather
+  {
+    static void declare_io(const tendrils& p, tendrils& i, tendrils& o)
+    {
+      i.declare(&Gather::in_, "in");
+      i["in"]->rate(Rate);
+      o.declare(&Gather::out_, "out");
+    }
+    int process(const tendrils&, const tendrils&)
+    {
+      seen.push_back(*in_);
+      *out_ = *in_;
+      return ecto::OK;
+    }
+    int process_batch(const tendrils_batch& in, tendrils_batch& out, std::size_t)
+    {
+      const tendrils_batch::column& values = in["in"];
+      for (std::size_t j = 0; j < values.size(); ++j)
+        seen.push_back(values[j].get<int>());
+      out.get<int>("out", 0) = seen.back();
+      return ecto::OK;
+    }
+    spore<int> in_, out_;
+    std::vector<int> seen;
+  };
+
+  struct Join
+  {
+    static void declare_io(const tendrils& p, tendrils& i, tendrils& o)
+    {
+      i.declare(&Join::left_, "left");
+      i.declare(&Join::right_, "right");
+    }
+    int process(const tendrils&, const tendrils&)
+    {
+      return ecto::OK;
+    }
+    spore<int> left_, right_;
+  };
+
+  std::size_t capacity(plasm& p)
+  {
+    graph::graph_t::edge_iterator b, e;
+    boost::tie(b, e) = boost::edges(p.graph());
+    return p.graph()[*b]->capacity();
+  }
+}
+
+TEST(Sdf, SingleRate)
+{
+  cell_ptr count = make<Count>(), collect = make<Collect<1> >();
+  plasm::ptr p(new plasm);
+  p->connect(count, "out", collect, "in");
+  schedulers::sdf sched(p);
+  sched.execute(4);
+  EXPECT_EQ(1u, sched.repetitions(count));
+  EXPECT_EQ(1u, sched.repetitions(collect));
+  EXPECT_EQ(2u, sched.period().size());
+  EXPECT_EQ(1u, sched.buffer(collect, "in"));
+  EXPECT_EQ(0u, capacity(*p)); //bounded for the run only
+  std::vector<int> expected;
+  for (int j = 1; j <= 4; ++j)
+    expected.push_back(j);
+  EXPECT_EQ(expected, impl<Collect<1> >(collect).seen);
+}
+
+TEST(Sdf, Decimate)
+{
+  cell_ptr count = make<Count>(), collect = make<Gather<3> >();
+  plasm::ptr p(new plasm);
+  p->connect(count, "out", collect, "in");
+  schedulers::sdf sched(p);
+  sched.execute(2);
+  EXPECT_EQ(3u, sched.repetitions(count));
+  EXPECT_EQ(1u, sched.repetitions(collect));
+  EXPECT_EQ(3u, sched.buffer(collect, "in"));
+  std::vector<int> expected;
+  for (int j = 1; j <= 6; ++j)
+    expected.push_back(j);
+  EXPECT_EQ(expected, impl<Gather<3> >(collect).seen);
+  EXPECT_EQ(6, collect->inputs.get<int>("in")); //the port holds the last value
+  EXPECT_EQ(2u, collect->stats.ncalls);
+}
+
+TEST(Sdf, Repeat)
+{
+  cell_ptr twice = make<Twice>(), collect = make<Collect<1> >();
+  plasm::ptr p(new plasm);
+  p->connect(twice, "out", collect, "in");
+  schedulers::sdf sched(p);
+  sched.execute(2);
+  EXPECT_EQ(1u, sched.repetitions(twice));
+  EXPECT_EQ(2u, sched.repetitions(collect));
+  EXPECT_EQ(2u, sched.buffer(collect, "in"));
+  int values[] = { 1, 2, 3, 4 };
+  EXPECT_EQ(std::vector<int>(values, values + 4), impl<Collect<1> >(collect).seen);
+}
+
+TEST(Sdf, MultiRateBuffer)
+{
+  //produces 2, consumes 3: the smallest buffer for a period is 2 + 3 - gcd(2, 3)
+  cell_ptr twice = make<Twice>(), collect = make<Gather<3> >();
+  plasm::ptr p(new plasm);
+  p->connect(twice, "out", collect, "in");
+  schedulers::sdf sched(p);
+  sched.execute(1);
+  EXPECT_EQ(3u, sched.repetitions(twice));
+  EXPECT_EQ(2u, sched.repetitions(collect));
+  EXPECT_EQ(5u, sched.period().size());
+  EXPECT_EQ(4u, sched.buffer(collect, "in"));
+  std::vector<int> expected;
+  for (int j = 1; j <= 6; ++j)
+    expected.push_back(j);
+  EXPECT_EQ(expected, impl<Gather<3> >(collect).seen);
+  EXPECT_EQ(0u, capacity(*p));
+}
+
+TEST(Sdf, InconsistentRates)
+{
+  //join would have to fire as often as count and a third as often.
+  cell_ptr count = make<Count>(), collect = make<Gather<3> >(), join = make<Join>();
+  plasm::ptr p(new plasm);
+  p->connect(count, "out", collect, "in");
+  p->connect(collect, "out", join, "left");
+  p->connect(count, "out", join, "right");
+  schedulers::sdf sched(p);
+  EXPECT_THROW(sched.execute(1), except::EctoException);
+  EXPECT_THROW(sched.execute(1), except::EctoException);
+}
+
+TEST(Sdf, MultiRateNeedsBatch)
+{
+  //Collect<3> only has a process, it can't take three values at once.
+  cell_ptr count = make<Count>(), collect = make<Collect<3> >();
+  plasm::ptr p(new plasm);
+  p->connect(count, "out", collect, "in");
+  schedulers::sdf sched(p);
+  EXPECT_THROW(sched.execute(1), except::EctoException);
+}
+
+TEST(Sdf, BoundTooSmall)
+{
+  //produces 2, consumes 3: the schedule holds 4 values, the edge only 3
+  cell_ptr twice = make<Twice>(), collect = make<Gather<3> >();
+  plasm::ptr p(new plasm);
+  p->connect(twice, "out", collect, "in", 3);
+  schedulers::sdf sched(p);
+  EXPECT_THROW(sched.execute(1), except::EctoException);
+  EXPECT_EQ(3u, capacity(*p));
+}
+
+TEST(Sdf, BoundLeftAlone)
+{
+  cell_ptr twice = make<Twice>(), collect = make<Gather<3> >();
+  plasm::ptr p(new plasm);
+  p->connect(twice, "out", collect, "in", 8);
+  schedulers::sdf sched(p);
+  sched.execute(1);
+  EXPECT_EQ(4u, sched.buffer(collect, "in"));
+  EXPECT_EQ(8u, capacity(*p));
+}
@@ -0,0 +1,140 @@
+//
+// Copyright (c) 2011, Willow Garage, Inc.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//     * Neither the name of the Willow Garage, Inc. nor the names of its
+//       contributors may be used to endorse or promote products derived from
+//       this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+#include <gtest/gtest.h>
+#include <ecto/thread_pool.hpp>
+
+#include <boost/bind.hpp>
+#include <boost/thread.hpp>
+
+#include <set>
+#include <stdexcept>
+#include <vector>
+
+using ecto::thread_pool;
+namespace {
+  struct record
+  {
+    boost::mutex mtx;
+    std::vector<unsigned> indices;
+    std::set<boost::thread::id> ids;
+
+    void operator()(unsigned j)
+    {
+      boost::mutex::scoped_lock lock(mtx);
+      indices.push_back(j);
+      ids.insert(boost::this_thread::get_id());
+    }
+  };
+
+  void job(record* r, unsigned j)
+  {
+    (*r)(j);
+  }
+
+  //! takes every thread of pool, then runs a crew of its own
+  void nested(thread_pool* pool, record* inner, unsigned j)
+  {
+    if (j != 0)
+      return;
+    thread_pool::crew c(*pool, 1, boost::bind(job, inner, _1));
+    EXPECT_EQ(1u, c.size());
+    EXPECT_TRUE(c.deferred());
+    c.join();
+    EXPECT_FALSE(c.deferred());
+    //no thread was started for it, it ran here
+    ASSERT_EQ(1u, inner->ids.size());
+    EXPECT_EQ(boost::this_thread::get_id(), *inner->ids.begin());
+  }
+
+  void throws(unsigned j)
+  {
+    if (j == 1)
+      throw std::runtime_error("job failed");
+  }
+}
+
+TEST(ThreadPool, Crew)
+{
+  thread_pool pool(4);
+  EXPECT_EQ(4u, pool.size());
+  record r;
+  {
+    thread_pool::crew c(pool, 3, boost::bind(job, &r, _1));
+    EXPECT_EQ(3u, c.size());
+    c.join();
+  }
+  std::set<unsigned> indices(r.indices.begin(), r.indices.end());
+  EXPECT_EQ(3u, r.indices.size());
+  EXPECT_EQ(3u, indices.size());
+  EXPECT_EQ(2u, *indices.rbegin());
+  EXPECT_EQ(4u, pool.idle());
+}
+
+TEST(ThreadPool, Reused)
+{
+  thread_pool pool(2);
+  record r;
+  for (unsigned j = 0; j < 50; ++j)
+    {
+      thread_pool::crew c(pool, 2, boost::bind(job, &r, _1));
+      c.join();
+    }
+  EXPECT_EQ(100u, r.indices.size());
+  EXPECT_GE(2u, r.ids.size());
+}
+
+TEST(ThreadPool, Exhausted)
+{
+  thread_pool pool(1);
+  record inner;
+  thread_pool::crew c(pool, 1, boost::bind(nested, &pool, &inner, _1));
+  c.join();
+  ASSERT_EQ(1u, inner.indices.size());
+  EXPECT_EQ(0u, inner.indices[0]);
+  EXPECT_EQ(1u, pool.size());
+}
+
+TEST(ThreadPool, Grows)
+{
+  thread_pool pool(1);
+  record r;
+  thread_pool::crew c(pool, 3, boost::bind(job, &r, _1));
+  EXPECT_EQ(3u, c.size());
+  c.join();
+  EXPECT_EQ(3u, pool.size());
+  EXPECT_EQ(3u, r.indices.size());
+}
+
+TEST(ThreadPool, Error)
+{
+  thread_pool pool(2);
+  thread_pool::crew c(pool, 2, throws);
+  EXPECT_THROW(c.join(), std::runtime_error);
+  c.join(); //reported once
+  EXPECT_EQ(2u, pool.idle());
+}
@@ -27,6 +27,8 @@
 //
 #include <gtest/gtest.h>
 #include <ecto/ecto.hpp>
+#include <ecto/registry.hpp>
+#include <boost/thread.hpp>
 
 
 using namespace ecto;
@@ -152,6 +154,80 @@ TEST(SporeTest, Callbacks)
   EXPECT_FALSE(d.dirty());
 }
 
+namespace
+{
+  struct make_dirty
+  {
+    std::vector<tendril_ptr>& ts;
+    make_dirty(std::vector<tendril_ptr>& ts_) : ts(ts_) { }
+    void operator()()
+    {
+      for (unsigned j = 0; j < 1000; ++j)
+        ts[j % ts.size()]->dirty(true);
+    }
+  };
+}
+
+TEST(SporeTest, DirtyList)
+{
+  dirty_list_ptr l(new dirty_list);
+  std::vector<tendril_ptr> ts;
+  std::vector<cbs<double> > c(8);
+  for (unsigned j = 0; j < c.size(); ++j)
+  {
+    ts.push_back(make_tendril<double>());
+    spore<double>(ts[j]).set_callback(boost::ref(c[j]));
+  }
+  ts[3]->dirty(true);
+  for (unsigned j = 0; j < ts.size(); ++j)
+    l->watch(ts[j]);
+  // already dirty when watched
+  EXPECT_FALSE(l->empty());
+  l->notify();
+  EXPECT_TRUE(l->empty());
+  EXPECT_EQ(1, c[3].count);
+  EXPECT_EQ(0, c[2].count);
+  // queued once no matter how often it is set dirty
+  ts[5]->dirty(true);
+  ts[5]->dirty(true);
+  ts[1]->dirty(true);
+  l->notify();
+  EXPECT_EQ(1, c[5].count);
+  EXPECT_EQ(1, c[1].count);
+  EXPECT_EQ(0, c[2].count);
+  l->notify();
+  EXPECT_EQ(1, c[5].count);
+  // from several threads
+  boost::thread_group g;
+  for (unsigned j = 0; j < 4; ++j)
+    g.create_thread(make_dirty(ts));
+  g.join_all();
+  l->notify();
+  for (unsigned j = 0; j < ts.size(); ++j)
+    EXPECT_FALSE(ts[j]->dirty());
+  EXPECT_TRUE(l->empty());
+  // a dead list is skipped
+  l.reset();
+  ts[0]->dirty(true);
+}
+
+TEST(SporeTest, DirtyParameters)
+{
+  cell::ptr gen = registry::create("ecto_test::Generate<double>");
+  gen->declare_params();
+  gen->declare_io();
+  cbs<double> c;
+  spore<double>(gen->parameters["step"]).set_callback(boost::ref(c));
+  gen->process();
+  EXPECT_EQ(0, c.count);
+  gen->parameters["step"] << 3.0;
+  gen->parameters["step"]->dirty(true);
+  gen->process();
+  gen->process();
+  EXPECT_EQ(1, c.count);
+  EXPECT_EQ(3.0, c.val);
+}
+
 TEST(SporeTest, Expressions)
 {
   tendril_ptr ta = make_tendril<double>(),
@@ -309,3 +385,28 @@ TEST(SporeTest, NullAssign)
 }
 
 
+
+TEST(SporeTest, FollowsTendril)
+{
+  tendril_ptr p = make_tendril<std::string>();
+  spore<std::string> s = p;
+  *s = "one";
+  // values moved in from an edge swap holders, the spore sees the new value
+  tendril other(std::string("two"), "");
+  p->move_from(other);
+  EXPECT_EQ("two", *s);
+  EXPECT_EQ(3u, s->size());
+  // and sees a frozen payload, copying it on write
+  p->freeze();
+  tendril copy(*p);
+  const spore<std::string>& cs = s;
+  EXPECT_EQ("two", *cs);
+  *s = "three";
+  EXPECT_EQ("two", copy.get<std::string>());
+  EXPECT_EQ("three", p->get<std::string>());
+  // a changed type is caught
+  *p = tendril(1.0, "");
+  EXPECT_THROW(*s, except::TypeMismatch);
+  *p = tendril(std::string("four"), "");
+  EXPECT_EQ("four", *s);
+}
@@ -31,6 +31,7 @@
 #include <ecto/plasm.hpp>
 #include <ecto/atomic.hpp>
 #include <ecto/schedulers/multithreaded.hpp>
+#include <ecto/schedulers/dataflow.hpp>
 #include <boost/exception/diagnostic_information.hpp>
 
 namespace bp = boost::python;
@@ -112,6 +113,18 @@ TEST(Strands, Crashy_is_ECTO_THREAD_UNSAFE)
   sched.execute(5);
 }
 
+TEST(Strands, Crashy_is_ECTO_THREAD_UNSAFE_dataflow)
+{
+  ecto::plasm::ptr p(new ecto::plasm);
+  for (unsigned j=0; j<10; ++j) {
+    ecto::cell::ptr m(new cell_<Crashy>);
+    p->insert(m);
+  }
+
+  ecto::schedulers::dataflow sched(p);
+  sched.execute(2, 4);
+}
+
 TEST(Strands, Crashy2_is_on_user_supplied_strand)
 {
   ecto::plasm::ptr p(new ecto::plasm);
@@ -179,6 +192,79 @@ TEST(Strands, ConcurrencyCount)
 }
 
 
+TEST(Strands, ConcurrencyCountWithinTick)
+{
+  {
+    ecto::atomic<int>::scoped_lock max_con(max_concurrent);
+    max_con.value = 0;
+  }
+  ecto::plasm::ptr p(new ecto::plasm);
+  for (unsigned j=0; j<10; ++j) {
+    ecto::cell::ptr m(new cell_<NotCrashy>);
+    p->insert(m);
+  }
+
+  //one tick: the ten independent cells are only run side by side by dataflow
+  ecto::schedulers::dataflow sched(p);
+  sched.execute(1, 4);
+  ecto::atomic<int>::scoped_lock cur_con(n_concurrent), max_con(max_concurrent);
+  ASSERT_EQ(cur_con.value, 0);
+  ASSERT_EQ(max_con.value, 4);
+}
+
+namespace
+{
+  //! only its own state is unsafe, each instance asserts it isn't reentered
+  struct Driver
+  {
+    int process(const ecto::tendrils&, const ecto::tendrils&)
+    {
+      boost::mutex::scoped_try_lock lock(mtx);
+      ECTO_ASSERT(lock.owns_lock(), "one instance run from two threads");
+      {
+        ecto::atomic<int>::scoped_lock nconc(n_concurrent), maxconc(max_concurrent);
+        ++nconc.value;
+        if (maxconc.value < nconc.value)
+          maxconc.value = nconc.value;
+      }
+      boost::this_thread::sleep(boost::posix_time::milliseconds(5));
+      {
+        ecto::atomic<int>::scoped_lock nconc(n_concurrent);
+        --nconc.value;
+      }
+      return ecto::OK;
+    }
+    boost::mutex mtx;
+  };
+}
+ECTO_THREAD_UNSAFE_PER_INSTANCE(Driver);
+
+TEST(Strands, PerInstance)
+{
+  ecto::cell::ptr a(new cell_<Driver>), b(new cell_<Driver>), c(new cell_<Crashy>),
+    d(new cell_<Crashy>);
+  ASSERT_TRUE(a->strand_);
+  ASSERT_TRUE(b->strand_);
+  EXPECT_FALSE(*a->strand_ == *b->strand_);
+  EXPECT_TRUE(*c->strand_ == *d->strand_);
+
+  {
+    ecto::atomic<int>::scoped_lock max_con(max_concurrent);
+    max_con.value = 0;
+  }
+  ecto::plasm::ptr p(new ecto::plasm);
+  for (unsigned j=0; j<10; ++j) {
+    ecto::cell::ptr m(new cell_<Driver>);
+    p->insert(m);
+  }
+  ecto::schedulers::multithreaded sched(p);
+  sched.execute(5, 4);
+  //each instance has its own strand, different ones run side by side
+  ecto::atomic<int>::scoped_lock cur_con(n_concurrent), max_con(max_concurrent);
+  ASSERT_EQ(0, cur_con.value);
+  EXPECT_LT(1, max_con.value);
+  EXPECT_GE(4, max_con.value);
+}
 
 TEST(Strands, Registry) {
   ecto::cell_ptr cp = ::ecto::registry::create("ecto_test::CantCallMeFromTwoThreads");
@@ -28,6 +28,7 @@
 #include <gtest/gtest.h>
 #include <ecto/all.hpp>
 #include <boost/exception/diagnostic_information.hpp>
+#include <stdexcept>
 
 namespace bp = boost::python;
 
@@ -545,3 +546,233 @@ TEST(TendrilTest, Nullptr)
     std::cout << boost::diagnostic_information(e) << "\n";
   }
 }
+
+TEST(TendrilTest, CopyReusesHolder)
+{
+  tendril a(std::string("hello"), "doc"), b(std::string("world"), "doc");
+  const std::string* held = &a.get<std::string>();
+  a = b;
+  EXPECT_EQ(held, &a.get<std::string>());
+  EXPECT_EQ("world", a.get<std::string>());
+  a << tendril(std::string("again"), "");
+  EXPECT_EQ(held, &a.get<std::string>());
+  EXPECT_EQ("again", a.get<std::string>());
+
+  // a different type gets a new holder
+  a = tendril(3.0, "");
+  EXPECT_TRUE(a.is_type<double>());
+  EXPECT_EQ(3.0, a.get<double>());
+}
+
+TEST(TendrilTest, MoveFrom)
+{
+  tendril slot(std::string("on the edge"), "");
+  slot.tick = 7;
+  tendril in(std::string("last tick"), "");
+  const char* data = slot.get<std::string>().data();
+  in.move_from(slot);
+  EXPECT_EQ("on the edge", in.get<std::string>());
+  EXPECT_EQ(data, in.get<std::string>().data());
+  EXPECT_EQ(7u, in.tick);
+  EXPECT_TRUE(in.user_supplied());
+  // the source keeps a value of the same type
+  EXPECT_EQ("last tick", slot.get<std::string>());
+
+  // mismatched types fall back to a copy
+  tendril none_in;
+  none_in.move_from(slot);
+  EXPECT_EQ("last tick", none_in.get<std::string>());
+  EXPECT_EQ("last tick", slot.get<std::string>());
+  tendril num(3.0, "");
+  EXPECT_THROW(num.move_from(slot), ecto::except::TypeMismatch);
+}
+
+TEST(TendrilTest, CopyValue)
+{
+  tendril port(2.5, "a documented port");
+  port.required(true);
+  port.tick = 3;
+  tendril slot;
+  slot.copy_value(port);
+  EXPECT_EQ(2.5, slot.get<double>());
+  EXPECT_EQ(3u, slot.tick);
+  // metadata stays with the port
+  EXPECT_EQ("", slot.doc());
+  EXPECT_FALSE(slot.required());
+  EXPECT_FALSE(slot.has_default());
+}
+
+namespace
+{
+  void count_calls(unsigned* n, double) { ++*n; }
+}
+
+TEST(TendrilTest, CopiesShareMetadata)
+{
+  tendril a(1.0, "the doc");
+  unsigned ncalls = 0;
+  a.set_callback<double>(boost::bind(count_calls, &ncalls, _1));
+  tendril b(a), c;
+  c = a;
+  EXPECT_EQ("the doc", b.doc());
+  EXPECT_EQ("the doc", c.doc());
+  // the callback stays with a
+  b.dirty(true);
+  b.notify();
+  EXPECT_EQ(0u, ncalls);
+  a.dirty(true);
+  a.notify();
+  EXPECT_EQ(1u, ncalls);
+  // changing a copy's metadata leaves the original alone
+  tendril e(1.0, "shared doc"), f(e);
+  f.set_doc("f's doc");
+  EXPECT_EQ("shared doc", e.doc());
+  EXPECT_EQ("f's doc", f.doc());
+  // a default tendril has no metadata to share
+  tendril d;
+  EXPECT_EQ("", d.doc());
+  d.notify();
+}
+
+TEST(TendrilTest, AssignmentKeepsCallbacks)
+{
+  tendril a(1.0, "a's doc"), b(2.0, "b's doc");
+  unsigned ncalls = 0;
+  a.set_callback<double>(boost::bind(count_calls, &ncalls, _1));
+  a = b;
+  EXPECT_EQ(2.0, a.get<double>());
+  EXPECT_EQ("b's doc", a.doc());
+  a.dirty(true);
+  a.notify();
+  EXPECT_EQ(1u, ncalls);
+  // and b got none of it
+  b.dirty(true);
+  b.notify();
+  EXPECT_EQ(1u, ncalls);
+  EXPECT_EQ("b's doc", b.doc());
+}
+
+TEST(TendrilTest, SharedPayload)
+{
+  tendril out(std::string("frame"), "an output");
+  out.shared_payload(true);
+  EXPECT_TRUE(out.shared_payload());
+  out.freeze();
+  EXPECT_TRUE(out.frozen());
+
+  tendril in1, in2;
+  in1 << out;
+  in2 << out;
+  const tendril& cin1 = in1;
+  const tendril& cin2 = in2;
+  // const access shares the one value
+  EXPECT_EQ(&cin1.get<std::string>(), &cin2.get<std::string>());
+  EXPECT_EQ("frame", cin1.get<std::string>());
+
+  const std::string* frozen = &cin1.get<std::string>();
+
+  // a new value lets go of the frozen one, which the others keep as it was
+  out << std::string("next");
+  EXPECT_FALSE(out.frozen());
+  EXPECT_EQ("next", out.get<std::string>());
+  EXPECT_EQ(frozen, &cin1.get<std::string>());
+  EXPECT_EQ(frozen, &cin2.get<std::string>());
+
+  // changing it in place copies on write
+  in1.get<std::string>() = "changed";
+  EXPECT_FALSE(in1.frozen());
+  EXPECT_EQ("changed", in1.get<std::string>());
+  EXPECT_EQ(frozen, &cin2.get<std::string>());
+  EXPECT_EQ("frame", cin2.get<std::string>());
+
+  // the last holder gets the value back without a copy
+  EXPECT_EQ(frozen, &in2.get<std::string>());
+  EXPECT_FALSE(in2.frozen());
+}
+
+namespace
+{
+  struct small_struct
+  {
+    double x, y, z;
+  };
+
+  template<typename T>
+  bool inside(const T* p, const tendril& t)
+  {
+    const char* c = reinterpret_cast<const char*>(p);
+    return c >= reinterpret_cast<const char*>(&t) && c < reinterpret_cast<const char*>(&t + 1);
+  }
+}
+
+TEST(TendrilTest, SmallValuesInline)
+{
+  EXPECT_TRUE(holder::is_inline<int>::value);
+  EXPECT_TRUE(holder::is_inline<double>::value);
+  EXPECT_TRUE(holder::is_inline<bool>::value);
+  EXPECT_TRUE(holder::is_inline<small_struct>::value);
+  EXPECT_TRUE(holder::is_inline<tendril::none>::value);
+  EXPECT_FALSE(holder::is_inline<std::string>::value);
+  EXPECT_FALSE(holder::is_inline<boost::shared_ptr<int> >::value);
+
+  small_struct s = { 1, 2, 3 };
+  tendril a(s, ""), b(std::string("heap"), "");
+  EXPECT_TRUE(inside(&a.get<small_struct>(), a));
+  EXPECT_FALSE(inside(&b.get<std::string>(), b));
+  tendril c(a);
+  EXPECT_TRUE(inside(&c.get<small_struct>(), c));
+  EXPECT_EQ(3, c.get<small_struct>().z);
+  // changing type in place
+  tendril d;
+  d = b;
+  EXPECT_EQ("heap", d.get<std::string>());
+  d = a;
+  EXPECT_EQ(2, d.get<small_struct>().y);
+}
+
+namespace
+{
+  struct throws_on_copy
+  {
+    throws_on_copy() { }
+    throws_on_copy(const throws_on_copy&)
+    {
+      throw std::runtime_error("no copies");
+    }
+  };
+}
+
+TEST(TendrilTest, HolderAssignStrong)
+{
+  holder h(std::string("old"));
+  EXPECT_THROW(h = throws_on_copy(), std::runtime_error);
+  ASSERT_TRUE(h.type() == typeid(std::string));
+  EXPECT_EQ("old", *h.unsafe_get<std::string>());
+}
+
+TEST(TendrilTest, TypeOps)
+{
+  tendril d(1.0, ""), i(1, ""), none;
+  // interned once, numbered densely
+  EXPECT_EQ(&types::of<double>(), &d.type());
+  EXPECT_EQ(&types::of<int>(), &i.type());
+  EXPECT_NE(d.type_id(), i.type_id());
+  EXPECT_LT(d.type_id(), types::end_id());
+  EXPECT_LT(i.type_id(), types::end_id());
+  EXPECT_LT(0u, none.type_id());
+  EXPECT_EQ(&d.type(), types::by_id(d.type_id()));
+  EXPECT_EQ(&d.type(), types::by_name("double"));
+  EXPECT_TRUE(types::by_id(0) == 0);
+  EXPECT_TRUE(types::by_name("not::a::type") == 0);
+  EXPECT_EQ("double", d.type().name());
+  // printing and serialization are registered by the library
+  EXPECT_TRUE(d.type().print != 0);
+  EXPECT_TRUE(d.type().serialize[type_ops::TEXT_OA] != 0);
+  EXPECT_TRUE(none.type().print == 0);
+  // copies carry the type along
+  tendril c(d);
+  EXPECT_TRUE(c.same_type(d));
+  EXPECT_TRUE(c.is_type<double>());
+  none << d;
+  EXPECT_EQ(d.type_id(), none.type_id());
+}
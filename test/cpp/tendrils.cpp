@@ -189,3 +189,49 @@ TEST(tendrils, SyntacticSugarness)
 }
 
 
+
+TEST(tendrils, Frozen)
+{
+  tendrils t;
+  t.declare<int>("b", "b's doc", 2);
+  t.declare<double>("a", "a's doc", 1.0);
+  t.declare<std::string>("c", "c's doc", "c");
+  EXPECT_FALSE(t.frozen());
+  EXPECT_THROW(t.handle("a"), ecto::except::EctoException);
+  t.freeze();
+  EXPECT_TRUE(t.frozen());
+  // handles are in key order
+  EXPECT_EQ(0u, t.handle("a"));
+  EXPECT_EQ(1u, t.handle("b"));
+  EXPECT_EQ(2u, t.handle("c"));
+  EXPECT_THROW(t.handle("d"), ecto::except::NonExistant);
+  EXPECT_THROW(t["d"], ecto::except::NonExistant);
+  EXPECT_EQ(t["b"], t.at(t.handle("b")));
+  t.at(t.handle("b")) << 5;
+  EXPECT_EQ(5, t.get<int>("b"));
+  // replacing a tendril through the key is seen through the handle
+  t["c"] = make_tendril<std::string>();
+  EXPECT_EQ(t["c"], t.at(2));
+  // changing the keys thaws
+  t.declare<int>("aa");
+  EXPECT_FALSE(t.frozen());
+  EXPECT_EQ(5, t.get<int>("b"));
+  t.freeze();
+  EXPECT_EQ(2u, t.handle("b"));
+}
+
+TEST(tendrils, FrozenByConfigure)
+{
+  cell::ptr add = registry::create("ecto_test::Add");
+  add->declare_params();
+  add->declare_io();
+  EXPECT_FALSE(add->inputs.frozen());
+  add->configure();
+  EXPECT_TRUE(add->inputs.frozen());
+  EXPECT_TRUE(add->outputs.frozen());
+  EXPECT_TRUE(add->parameters.frozen());
+  add->inputs.at(add->inputs.handle("left")) << 2.0;
+  add->inputs["right"] << 3.0;
+  add->process();
+  EXPECT_EQ(5.0, add->outputs.get<double>("out"));
+}
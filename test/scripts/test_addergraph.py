@@ -80,8 +80,9 @@ def build_addergraph(nlevels):
 
 
 @test
-def test_plasm_impl(sched_type, nlevels, nthreads, niter):
+def test_plasm_impl(sched_type, nlevels, nthreads, niter, edge_queue):
     (plasm, outnode) = build_addergraph(nlevels)
+    plasm.edge_queue = edge_queue
     sched = sched_type(plasm)
     sched.execute(niter, nthreads)
     print "RESULT:", outnode.outputs.out
@@ -91,7 +92,8 @@ def test_plasm_impl(sched_type, nlevels, nthreads, niter):
 
 def test_plasm(nlevels, nthreads, niter):
     for sched in ecto.test.schedulers:
-        test_plasm_impl(sched, nlevels, nthreads, niter)
+        for edge_queue in [ecto.EdgeQueue.DEQUE, ecto.EdgeQueue.RINGBUFFER]:
+            test_plasm_impl(sched, nlevels, nthreads, niter, edge_queue)
 
 if __name__ == '__main__':
     test_plasm(1, 1, 1)
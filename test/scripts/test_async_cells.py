@@ -0,0 +1,62 @@
+#!/usr/bin/env python
+# 
+# Copyright (c) 2011, Willow Garage, Inc.
+# All rights reserved.
+# 
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions are met:
+#     * Redistributions of source code must retain the above copyright
+#       notice, this list of conditions and the following disclaimer.
+#     * Redistributions in binary form must reproduce the above copyright
+#       notice, this list of conditions and the following disclaimer in the
+#       documentation and/or other materials provided with the distribution.
+#     * Neither the name of the Willow Garage, Inc. nor the names of its
+#       contributors may be used to endorse or promote products derived from
+#       this software without specific prior written permission.
+# 
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+# AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+# ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+# LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+# CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+# SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+# INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+# CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+# ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+# POSSIBILITY OF SUCH DAMAGE.
+import ecto
+import ecto.ecto_test as ecto_test
+from ecto.test import schedulers
+
+def test_async_sleep(Sched):
+    plasm = ecto.Plasm()
+    gen = ecto_test.Generate(start=1, step=1)
+    sleep = ecto_test.AsyncSleep(seconds=0.005)
+    inc = ecto_test.Increment()
+    plasm.connect(gen["out"] >> sleep["in"],
+                  sleep["out"] >> inc["in"])
+    sched = Sched(plasm)
+    sched.execute(niter=10)
+    print Sched.__name__, inc.outputs.out
+    assert inc.outputs.out == 11
+
+def test_async_fail(Sched):
+    plasm = ecto.Plasm()
+    gen = ecto_test.Generate(start=1, step=1)
+    sleep = ecto_test.AsyncSleep(seconds=0.001, fail_at=3)
+    inc = ecto_test.Increment()
+    plasm.connect(gen["out"] >> sleep["in"],
+                  sleep["out"] >> inc["in"])
+    sched = Sched(plasm)
+    try:
+        sched.execute(niter=10)
+        assert False, "should have thrown"
+    except ecto.CellException, e:
+        print Sched.__name__, "threw", e
+    assert inc.outputs.out <= 4
+
+if __name__ == '__main__':
+    for s in schedulers:
+        test_async_sleep(s)
+        test_async_fail(s)
@@ -93,6 +93,30 @@ def test_bb_fail(options):
         print str(e)
         assert "I hate life" in str(e)
 
+def bb_plasm(**kwargs):
+    mm = MyBlackBox(start=10, step=3, amount=2, **kwargs)
+    inc = ecto_test.Increment()
+    plasm = ecto.Plasm()
+    plasm.connect(mm['value'] >> inc['in'])
+    return plasm, mm, inc
+
+def test_bb_flatten():
+    plasm, mm, inc = bb_plasm()
+    nested = ecto.schedulers.Singlethreaded(plasm)
+    nested.execute(niter=5)
+
+    flat, fmm, finc = bb_plasm()
+    assert flat.flatten() == 1
+    assert len(flat.cells()) == 4
+    ecto.schedulers.Dataflow(flat).execute(niter=5, nthreads=2)
+    print "nested", inc.outputs.out, "flattened", finc.outputs.out
+    assert finc.outputs.out == inc.outputs.out
+    assert fmm.outputs.value == mm.outputs.value
+
+    #a BlackBox run several times per tick stays as it is
+    looped, lmm, linc = bb_plasm(niter=2)
+    assert looped.flatten() == 0
+
 def test_command_line_args():
     import argparse
     from ecto.opts import cell_options
@@ -130,4 +154,5 @@ if __name__ == '__main__':
     options = parser.parse_args()
     test_bb(options)
     test_bb_fail(options)
+    test_bb_flatten()
 
@@ -0,0 +1,113 @@
+#!/usr/bin/env python
+# 
+# Copyright (c) 2011, Willow Garage, Inc.
+# All rights reserved.
+# 
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions are met:
+#     * Redistributions of source code must retain the above copyright
+#       notice, this list of conditions and the following disclaimer.
+#     * Redistributions in binary form must reproduce the above copyright
+#       notice, this list of conditions and the following disclaimer in the
+#       documentation and/or other materials provided with the distribution.
+#     * Neither the name of the Willow Garage, Inc. nor the names of its
+#       contributors may be used to endorse or promote products derived from
+#       this software without specific prior written permission.
+# 
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+# AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+# ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+# LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+# CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+# SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+# INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+# CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+# ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+# POSSIBILITY OF SUCH DAMAGE.
+import ecto
+import ecto.ecto_test as ecto_test
+
+class Aligned(ecto.Cell):
+    """Checks that the value coming around the lossy branch matches the
+    one taken straight from the source."""
+    @staticmethod
+    def declare_params(params):
+        pass
+
+    @staticmethod
+    def declare_io(params, inputs, outputs):
+        inputs.declare("lossy", "Generate then Increment over a lossy edge.", 0.0)
+        inputs.declare("direct", "Generate directly.", 0.0)
+        outputs.declare("count", "Ticks that made it through.", 0)
+
+    def configure(self, params):
+        pass
+
+    def process(self, inputs, outputs):
+        assert inputs.lossy == inputs.direct + 1, (inputs.lossy, inputs.direct)
+        outputs.count += 1
+        return 0
+
+def test_connect_bounded():
+    plasm = ecto.Plasm()
+    gen = ecto_test.Generate(start=1, step=1)
+    inc = ecto_test.Increment()
+    inc2 = ecto_test.Increment()
+    plasm.connect(gen, "out", inc, "in", 3, ecto.Overflow.DROP_OLDEST)
+    plasm.connect(inc["out"] >> inc2["in"], capacity=2)
+    stats = sorted((capacity, dropped, blocked)
+                   for c, capacity, dropped, blocked in plasm.edge_stats())
+    print stats
+    assert stats == [(2, 0, 0.0), (3, 0, 0.0)]
+    sched = ecto.schedulers.Singlethreaded(plasm)
+    sched.execute(niter=5)
+    assert inc2.outputs.out == 7
+    for c, capacity, dropped, blocked in plasm.edge_stats():
+        assert dropped == 0
+
+def test_drop_newest_threaded():
+    plasm = ecto.Plasm()
+    gen = ecto_test.Generate(start=1, step=1)
+    inc = ecto_test.Increment(delay=2)
+    plasm.connect(gen[:] >> inc[:], capacity=1, overflow=ecto.DROP_NEWEST)
+    sched = ecto.schedulers.Multithreaded(plasm)
+    sched.execute(niter=40, nthreads=4)
+    ((_, capacity, dropped, blocked),) = plasm.edge_stats()
+    print "dropped", dropped
+    assert capacity == 1
+    assert dropped > 0
+    assert inc.outputs.out <= 41
+
+def test_drop_join_threaded():
+    plasm = ecto.Plasm()
+    gen = ecto_test.Generate(start=1, step=1)
+    inc = ecto_test.Increment(delay=2)
+    check = Aligned()
+    plasm.connect(gen[:] >> inc[:], capacity=1, overflow=ecto.DROP_NEWEST)
+    plasm.connect(inc["out"] >> check["lossy"],
+                  gen["out"] >> check["direct"])
+    sched = ecto.schedulers.Multithreaded(plasm)
+    sched.execute(niter=40, nthreads=4)
+    dropped = sum(d for c, capacity, d, blocked in plasm.edge_stats())
+    print "dropped", dropped, "count", check.outputs.count
+    assert dropped > 0
+    assert 0 < check.outputs.count < 40
+
+def test_block_shared_strand():
+    # the producer would wait for room holding the strand its consumer needs
+    for Sched in (ecto.schedulers.Multithreaded, ecto.schedulers.Pipelined):
+        s = ecto.Strand()
+        plasm = ecto.Plasm()
+        gen = ecto_test.Generate(start=1, step=1, strand=s)
+        inc = ecto_test.Increment(delay=1, strand=s)
+        plasm.connect(gen[:] >> inc[:], capacity=1)
+        sched = Sched(plasm)
+        sched.execute(niter=20, nthreads=4)
+        assert inc.outputs.out == 21
+
+if __name__ == '__main__':
+    test_connect_bounded()
+    test_drop_newest_threaded()
+    test_drop_join_threaded()
+    test_block_shared_strand()